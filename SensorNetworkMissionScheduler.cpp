@@ -9,15 +9,46 @@
 //             approaches with regards to how well they make use of the
 //             network's resources.
 #include <iostream>
+#include <fstream>
+#include <string>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <vector>
+#include <cmath>
+#include <cstring>
+#include <algorithm>
+#include <queue>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <stdint.h>
+#include <climits>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <sstream>
+#include <sys/wait.h>
+#ifdef SNMS_BENCHMARK
+#include <map>
+#include <sys/resource.h>
+#endif
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define SNMS_HAVE_AVX2 1 //AVX2 kernels can be compiled on this target
+#include <immintrin.h>
+#endif
 using namespace std;
 
 //////////////////////////////////////////////////////////////////////////
 ///////////////////////////GLOBAL_CONSTANTS///////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 
+//These are the defaults for a run. Each one can be changed at run time
+//from the command line or a sweep configuration file.
 const int MSV = 50; //Maximum Variance in Mission Start time
 const int AOI_W = 50; //Largest X-Coord within Area of Interest
 const int AOI_H = 50; //Largest Y-Coord within Area of Interest
@@ -25,33 +56,348 @@ const int M_RAD = 5; //Mission's Range from Epicenter for Sensor Detection
 const int M_COUNT = 1000; //Number of missions
 const int NUM_TEST = 3; //Amount of times primary loop will run before
 //averaging all results together.
+const int MAX_TEST = 1000; //Most trials run while aiming for --ci-width
+
+//////////////////////////////////////////////////////////////////////////
+///////////////////////////INSTRUMENTATION////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//When built with SNMS_INSTRUMENT defined ("make instrument"), the hot
+//paths count the work they do and each trial times its phases. Every
+//thread counts into its own thread_local block, which is added to the
+//process totals when the thread finishes, so counting never contends.
+//The totals are written to cerr as JSON at the end of a run. Without
+//SNMS_INSTRUMENT the macros expand to nothing.
+
+enum Counter
+{
+  C_IS_SCHEDULABLE, //Schedulability tests of a sensor against a mission
+  C_IN_RANGE, //Sensor-mission distance tests
+  C_RANDOM_DRAW, //Random picks made by randomAssign
+  C_CALC_TE, //calcTE calls
+  C_TE_REEVAL, //TEs recomputed by the Offline Algorithm after a change
+  NUM_COUNTERS
+};
+
+enum Phase
+{
+  P_GENERATION, //Building the network and mission list
+  P_GRAPH, //Building the EligibilityGraph
+  P_RANDOM, //Running the Random Algorithm
+  P_ONLINE, //Running the Online Algorithm
+  P_OFFLINE, //Running the Offline Algorithm
+  P_BATCH, //Running the Batch Algorithm
+  P_POLICY, //Running the policy chosen by --policy
+  P_CLEANUP, //Resetting between and after the algorithms
+  NUM_PHASES
+};
+
+#ifdef SNMS_INSTRUMENT
+
+const char* const COUNTER_NAMES[NUM_COUNTERS] =
+  {"is_schedulable", "in_range", "random_draws", "calc_te", "te_reevals"};
+const char* const PHASE_NAMES[NUM_PHASES] =
+  {"generation", "graph", "random", "online", "offline", "batch",
+   "policy", "cleanup"};
+
+//These are the counts and phase times gathered by a thread, or in total.
+struct Instrument
+{
+  unsigned long long count[NUM_COUNTERS]; //Value of each counter
+  double phase_ns[NUM_PHASES]; //Time spent in each phase
+};
+
+thread_local Instrument inst_local = Instrument(); //This thread's counts
+Instrument inst_total = Instrument(); //Counts of every finished thread
+mutex inst_lock; //Guards inst_total
+
+//This object times a sequence of phases. Starting a phase ends the one
+//before it, and the last phase ends when the timer goes out of scope.
+class PhaseTimer
+{
+  private:
+    int p_phase; //Phase being timed, or -1 if none
+    chrono::steady_clock::time_point p_start; //When it started
+
+  public:
+
+    //CONSTRUCTOR
+    PhaseTimer(){ p_phase = -1; }
+
+    //DESTRUCTOR
+    ~PhaseTimer(){ stop(); }
+
+    //START FUNCTION
+    //Description: Ends the current phase, if any, and starts timing phase.
+    void start(const int phase)
+    {
+      stop();
+      p_phase = phase;
+      p_start = chrono::steady_clock::now();
+    }
+
+    //STOP FUNCTION
+    //Description: Ends the current phase, adding its time to the thread's
+    //total for that phase.
+    void stop()
+    {
+      if (p_phase >= 0)
+      {
+        inst_local.phase_ns[p_phase] += chrono::duration<double, nano>(
+          chrono::steady_clock::now() - p_start).count();
+        p_phase = -1;
+      }
+    }
+
+};
+
+//FLUSH FUNCTION
+//Description: Adds this thread's counts to the process totals and clears
+//them. Each thread calls it before it finishes.
+void instrumentFlush()
+{
+  lock_guard<mutex> hold(inst_lock);
+  for (int c = 0; c < NUM_COUNTERS; c++)
+  {
+    inst_total.count[c] += inst_local.count[c];
+  }
+  for (int p = 0; p < NUM_PHASES; p++)
+  {
+    inst_total.phase_ns[p] += inst_local.phase_ns[p];
+  }
+  inst_local = Instrument();
+  return;
+}
+
+//DUMP FUNCTION
+//Description: Writes the process totals as one JSON object. Phase times
+//are summed over threads, in milliseconds.
+void instrumentDump(ostream & out)
+{
+  instrumentFlush();
+  out << "{\"counters\":{";
+  for (int c = 0; c < NUM_COUNTERS; c++)
+  {
+    out << (c ? "," : "") << "\"" << COUNTER_NAMES[c] << "\":"
+        << inst_total.count[c];
+  }
+  out << "},\"phases_ms\":{";
+  for (int p = 0; p < NUM_PHASES; p++)
+  {
+    out << (p ? "," : "") << "\"" << PHASE_NAMES[p] << "\":"
+        << inst_total.phase_ns[p]/1e6;
+  }
+  out << "}}" << endl;
+  return;
+}
+
+#define SNMS_COUNT(counter, n) (inst_local.count[counter] += (n))
+#define SNMS_PHASE_TIMER(timer) PhaseTimer timer
+#define SNMS_PHASE(timer, phase) timer.start(phase)
+#define SNMS_FLUSH() instrumentFlush()
+#define SNMS_DUMP(out) instrumentDump(out)
+#else
+#define SNMS_COUNT(counter, n) ((void)0)
+#define SNMS_PHASE_TIMER(timer) ((void)0)
+#define SNMS_PHASE(timer, phase) ((void)0)
+#define SNMS_FLUSH() ((void)0)
+#define SNMS_DUMP(out) ((void)0)
+#endif
 
 //////////////////////////////////////////////////////////////////////////
 //////////////////////////SPECIAL_FUNCTIONS///////////////////////////////
 //////////////////////////////////////////////////////////////////////////
 
+//RANDOM GENERATOR
+//Description: A small splitmix64 generator that replaces the global rand()
+//state. Every trial owns its own generators, so trials can run on any
+//thread in any order and still draw exactly the same numbers. Each trial
+//uses separate streams for sensor placement, mission generation and the
+//Random Algorithm, derived from the run's seed and the trial number.
+const int RNG_MAX = 2147483647; //Largest value returned by RandGen::next
+
+class RandGen
+{
+  private:
+    uint64_t r_state; //Current generator state
+
+    //MIX FUNCTION
+    //Description: The splitmix64 finalizer. Scrambles a 64-bit value.
+    static uint64_t mix(uint64_t z)
+    {
+      z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+      return z ^ (z >> 31);
+    }
+
+  public:
+    //Stream identifiers used within a trial
+    enum Stream { SENSOR_STREAM = 0, MISSION_STREAM = 1, RANDOM_STREAM = 2,
+                  POLICY_STREAM = 3, MIX_STREAM = 4 };
+
+    //CONSTRUCTORS
+    RandGen(uint64_t seed){ r_state = seed; }
+    RandGen(uint64_t seed, int trial, Stream stream)
+    {
+      r_state = mix(mix(seed + 0x9E3779B97F4A7C15ULL*(trial + 1)) +
+                    static_cast<uint64_t>(stream));
+    }
+
+    //NEXT FUNCTION
+    //Description: Returns a uniformly distributed int on [0, RNG_MAX].
+    int next()
+    {
+      r_state += 0x9E3779B97F4A7C15ULL;
+      return static_cast<int>(mix(r_state) >> 33);
+    }
+
+    //ACCESSOR FUNCTIONS
+    uint64_t getSTATE()const{ return r_state; }
+
+    //MUTATOR FUNCTIONS
+    void setSTATE(const uint64_t state){ r_state = state; }
+};
+
 //PLACEMENT FUNCTION
 //Description: Used to generate a random float between 0 and coord_max.
 //Value is stored in the passed float. More formally, c = (0, coord_max)
 //after this function runs. Thus, this function can be used to "place"
 //Mission Epicenters and Sensors by being passed the respective bound of
-//the AoI and then the coordinate to be generated. 
-void place(const int coord_max, float & c)
+//the AoI and then the coordinate to be generated. Numbers are drawn from
+//the passed generator.
+void place(const int coord_max, float & c, RandGen & rng)
 {
   int z = 0;
-  while(z == 0 || z == RAND_MAX) //Ensures z is on (0, RAND_MAX)
+  while(z == 0 || z == RNG_MAX) //Ensures z is on (0, RNG_MAX)
   {
-    z = rand();
+    z = rng.next();
   }
-  c = (static_cast<float>(z)/static_cast<float>(RAND_MAX))+(rand()%coord_max);
-  //After we ensure z follows the interval (0, RAND_MAX), we divide it by
-  //RAND_MAX. So, z will now be on the interval of (0, 1). We then add that
+  c = (static_cast<float>(z)/static_cast<float>(RNG_MAX))+
+      (rng.next()%coord_max);
+  //After we ensure z follows the interval (0, RNG_MAX), we divide it by
+  //RNG_MAX. So, z will now be on the interval of (0, 1). We then add that
   //value to an integer that follows the interval [0, coord_max], and then
   //store the result into c. Therefore, c will be some float on the interval 
   //(0, coord_max).
   return;
 }
 
+//SIMD KERNELS
+//Description: These kernels test many sensors against one mission in a
+//single pass over contiguous coordinate and energy arrays. A sensor passes
+//if it is within r2 (the squared radius) of (ex, ey) and has at least
+//min_energy energy. The index of every passing sensor is written to out,
+//in the order tested, and the amount written is returned. If idx is given,
+//lane i is sensor idx[i] and its energy is read from energy[idx[i]];
+//otherwise lane i is sensor first + i. The distance test performs the same
+//float operations as Mission::inRange, so every kernel agrees with it
+//exactly. An AVX2 version is used when the processor supports it.
+bool use_simd = true; //Cleared to force the scalar kernels
+
+int selectInRangeScalar(const float* x, const float* y, const int* energy,
+                        const int* idx, const int first, const int n,
+                        const float ex, const float ey, const float r2,
+                        const int min_energy, int* out)
+{
+  int count = 0; //Number of sensors written to out
+  for (int i = 0; i < n; i++)
+  {
+    float xdist = ex - x[i];
+    float ydist = ey - y[i];
+    float EuD_squared = (xdist*xdist)+(ydist*ydist);
+    int sensor = (idx != NULL) ? idx[i] : first + i;
+    if (r2 >= EuD_squared && energy[sensor] >= min_energy)
+    {
+      out[count++] = sensor;
+    }
+  }
+  return count;
+}
+
+#ifdef SNMS_HAVE_AVX2
+__attribute__((target("avx2")))
+int selectInRangeAVX2(const float* x, const float* y, const int* energy,
+                      const int* idx, const int first, const int n,
+                      const float ex, const float ey, const float r2,
+                      const int min_energy, int* out)
+{
+  const __m256 v_ex = _mm256_set1_ps(ex);
+  const __m256 v_ey = _mm256_set1_ps(ey);
+  const __m256 v_r2 = _mm256_set1_ps(r2);
+  const __m256i v_min = _mm256_set1_epi32(min_energy);
+  const __m256i v_lane = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  int count = 0; //Number of sensors written to out
+  int i = 0;
+  for (; i + 8 <= n; i += 8)
+  {
+    __m256 xdist = _mm256_sub_ps(v_ex, _mm256_loadu_ps(x + i));
+    __m256 ydist = _mm256_sub_ps(v_ey, _mm256_loadu_ps(y + i));
+    __m256 d2 = _mm256_add_ps(_mm256_mul_ps(xdist, xdist),
+                              _mm256_mul_ps(ydist, ydist));
+    __m256i in_range = _mm256_castps_si256(_mm256_cmp_ps(d2, v_r2,
+                                                         _CMP_LE_OQ));
+    __m256i sensors;
+    __m256i en;
+    if (idx != NULL)
+    {
+      sensors = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      en = _mm256_i32gather_epi32(energy, sensors, 4);
+    }
+    else
+    {
+      sensors = _mm256_add_epi32(_mm256_set1_epi32(first + i), v_lane);
+      en = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(energy +
+                                                               first + i));
+    }
+    __m256i low = _mm256_cmpgt_epi32(v_min, en); //Lanes below min_energy
+    int bits = _mm256_movemask_ps(_mm256_castsi256_ps(
+                 _mm256_andnot_si256(low, in_range)));
+    if (bits != 0)
+    {
+      int lanes[8];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sensors);
+      while (bits != 0) //Writes out each passing lane
+      {
+        int lane = __builtin_ctz(bits);
+        out[count++] = lanes[lane];
+        bits &= bits - 1;
+      }
+    }
+  }
+  return count + selectInRangeScalar(x + i, y + i, energy,
+                                     (idx != NULL) ? idx + i : NULL,
+                                     first + i, n - i, ex, ey, r2,
+                                     min_energy, out + count);
+}
+
+//AVX2 DETECTION FUNCTION
+//Description: Returns true if the AVX2 kernels may be used.
+bool haveAVX2()
+{
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return use_simd && supported;
+}
+#endif
+
+//SELECTION KERNEL
+//Description: Dispatches to the fastest available selection kernel.
+int selectInRange(const float* x, const float* y, const int* energy,
+                  const int* idx, const int first, const int n,
+                  const float ex, const float ey, const float r2,
+                  const int min_energy, int* out)
+{
+  SNMS_COUNT(C_IN_RANGE, n);
+#ifdef SNMS_HAVE_AVX2
+  if (haveAVX2())
+  {
+    return selectInRangeAVX2(x, y, energy, idx, first, n, ex, ey, r2,
+                             min_energy, out);
+  }
+#endif
+  return selectInRangeScalar(x, y, energy, idx, first, n, ex, ey, r2,
+                             min_energy, out);
+}
+
 //////////////////////////////////////////////////////////////////////////
 /////////////////////////////////CLASSES//////////////////////////////////
 //////////////////////////////////////////////////////////////////////////
@@ -67,36 +413,60 @@ class Mission
     int m_e; //Mission End
     float m_ex; //Mission Epicenter's X coordinate
     float m_ey; //Mission Epicenter's Y coordinate
+    float m_rad; //Mission's Range from Epicenter for Sensor Detection
+    int m_req; //Sensors the mission needs, or 0 to use the run's count
+    int m_index; //Position of the mission in its list, or -1 if unknown
     
   public:
     bool attempted; //Stores if mission was attempted to have been completed
         
     //CONSTRUCTOR
-    Mission(int start_time, int duration)
+    //Description: Places the mission's epicenter at random within an AoI
+    //of aoi_w by aoi_h.
+    Mission(int start_time, int duration, float radius, int aoi_w, int aoi_h,
+            RandGen & rng)
+    {
+      attempted = false;
+      m_req = 0;
+      m_index = -1;
+      m_s = start_time;
+      m_e = m_s + duration;
+      m_rad = radius;
+      place(aoi_w, m_ex, rng); //Generates a valid x-coordinate on (0, aoi_w)
+      place(aoi_h, m_ey, rng); //Generates a valid y-coordinate on (0, aoi_h)
+    }
+
+    //CONSTRUCTOR
+    //Description: Builds a mission with a known epicenter.
+    Mission(int start_time, int duration, float ex, float ey, float radius)
     {
       attempted = false;
+      m_req = 0;
+      m_index = -1;
       m_s = start_time;
       m_e = m_s + duration;
-      place(AOI_W, m_ex); //Generates a valid x-coordinate on (0, AOI_W)
-      place(AOI_H, m_ey); //Generates a valid y-coordinate on (0, AOI_H)
+      m_ex = ex;
+      m_ey = ey;
+      m_rad = radius;
     }
     
     //INRANGE FUNCTION
-    //Description: Using the constant M_RAD as the radius of the mission's
-    //range, tests to see if some pair of coordinates is within this
-    //range. In other words, it tests to see if the Euclidean Distance
-    //of the passed coordinates is < M_RAD.
+    //Description: Using m_rad as the radius of the mission's range, tests
+    //to see if some pair of coordinates is within this range. In other
+    //words, it tests to see if the Euclidean Distance of the passed
+    //coordinates is < m_rad.
     bool inRange(const float x, const float y)const
     {
+      SNMS_COUNT(C_IN_RANGE, 1);
       float xdist = m_ex - x; //Stores the difference in x
       float ydist = m_ey - y; //Stores the difference in y
       float EuD_squared = (xdist*xdist)+(ydist*ydist); //Calculates the
       //Euclidean Distance squared.
-      if((M_RAD*M_RAD) >= EuD_squared) //If the EuD is < M_RAD
+      if((m_rad*m_rad) >= EuD_squared) //If the EuD is < m_rad
       {
         return true; //The passed coordinates are "in range"
       }
-      else //The EuD is greater than M_RAD
+      else //The EuD is greater than m_rad
       {
         return false; //The coordinates are not "in range"
       }
@@ -107,6 +477,21 @@ class Mission
     int getEND()const{ return m_e; }
     float getEX()const{ return m_ex; }
     float getEY()const{ return m_ey; }
+    float getRAD()const{ return m_rad; }
+    int getREQ()const{ return m_req; }
+    int getINDEX()const{ return m_index; }
+
+    //DEMAND FUNCTION
+    //Description: Returns how many sensors the mission needs, given the
+    //count every mission of the run needs unless it sets its own.
+    int demand(const int num_sensors)const
+    {
+      return m_req > 0 ? m_req : num_sensors;
+    }
+
+    //MUTATOR FUNCTIONS
+    void setINDEX(const int index){ m_index = index; }
+    void setREQ(const int req){ m_req = req; }
     
 };
       
@@ -123,11 +508,295 @@ class Schedule
     int s_start; //Stores beginning of some time period
     int s_end; //Stores end of some time period
     
+    //DEFAULT CONSTRUCTOR
+    Schedule(){ s_start = 0; s_end = 0; }
+
     //CONSTRUCTOR
     Schedule(int s, int e){ s_start = s; s_end = e; }
     
 };
 
+////////////////////
+///SCHEDULE_ARENA///
+////////////////////
+
+//This object holds the schedules of every sensor in a Network, in one
+//array that only grows. A timeline is given a block of slots, and when it
+//fills up it moves to a block twice the size and releases the old one.
+//Released blocks are kept on a free list per size, and handed out again
+//before the array grows, so a long stream that never rewinds only holds
+//as much as its timelines need at their peak. Rewinding marks every slot
+//free at once, so a reset network reuses the same memory with no calls
+//to the allocator.
+//Blocks are named by offset rather than address, so the array can grow,
+//and a copy of a Network, arena and all, stays consistent.
+
+class ScheduleArena
+{
+  private:
+    vector<Schedule> a_slots; //Every slot, used or not
+    int a_used; //Number of slots handed out since the last rewind
+    vector<vector<int> > a_free; //Released blocks, by log2 of their size
+
+    //SIZE CLASS FUNCTION
+    //Description: Returns the free list for blocks of count slots, or -1
+    //if count isn't a power of two.
+    static int sizeClass(const int count)
+    {
+      return (count > 0 && (count & (count - 1)) == 0) ?
+             __builtin_ctz(count) : -1;
+    }
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    ScheduleArena(){ a_used = 0; }
+
+    //ALLOCATE FUNCTION
+    //Description: Hands out a block of count slots and returns its offset,
+    //reusing a released block of the same size if there is one.
+    int allocate(const int count)
+    {
+      int size_class = sizeClass(count);
+      if (size_class >= 0 && size_class < static_cast<int>(a_free.size()) &&
+          !a_free[size_class].empty())
+      {
+        int block = a_free[size_class].back();
+        a_free[size_class].pop_back();
+        return block;
+      }
+      int first = a_used;
+      a_used += count;
+      if (a_used > static_cast<int>(a_slots.size()))
+      {
+        a_slots.resize(max(a_used, 2*static_cast<int>(a_slots.size())));
+      }
+      return first;
+    }
+
+    //RELEASE FUNCTION
+    //Description: Returns a block of count slots that is no longer used.
+    void release(const int offset, const int count)
+    {
+      int size_class = sizeClass(count);
+      if (size_class < 0)
+      {
+        return;
+      }
+      if (size_class >= static_cast<int>(a_free.size()))
+      {
+        a_free.resize(size_class + 1);
+      }
+      a_free[size_class].push_back(offset);
+      return;
+    }
+
+    //REWIND FUNCTION
+    //Description: Frees every block at once. Timelines holding blocks
+    //must be cleared as well.
+    void rewind()
+    {
+      a_used = 0;
+      for (size_t c = 0; c < a_free.size(); c++)
+      {
+        a_free[c].clear();
+      }
+    }
+
+    //ACCESSOR FUNCTIONS
+    Schedule* at(const int offset){ return &a_slots[offset]; }
+    const Schedule* at(const int offset)const{ return &a_slots[offset]; }
+    int getUSED()const{ return a_used; }
+
+};
+
+//////////////
+///TIMELINE///
+//////////////
+
+//This object stores a sensor's schedules sorted by (s_start, s_end). Since
+//a sensor is never given two overlapping schedules, sorting them by start
+//also sorts them by end, so only the last schedule starting before some
+//time can overlap a period ending at that time. This lets overlap tests run
+//in logarithmic time rather than scanning every schedule. The schedules
+//live in a block of the owning Network's ScheduleArena, at slots t_head up
+//to t_size; schedules before t_head have been expired.
+
+class Timeline
+{
+  private:
+    int t_block; //Offset of the block in the arena, or -1 if none
+    int t_cap; //Number of slots in the block
+    int t_head; //First slot still in use
+    int t_size; //One past the last slot in use
+    int t_last_end; //End of the last schedule, or INT_MIN if none
+
+    //ORDER FUNCTION
+    //Description: Used for binary searches over the schedules. Orders
+    //schedules by start time, then by end time.
+    static bool before(const Schedule & a, const Schedule & b)
+    {
+      return a.s_start < b.s_start ||
+             (a.s_start == b.s_start && a.s_end < b.s_end);
+    }
+
+    //START ORDER FUNCTION
+    //Description: Used to find the first schedule starting at or after t.
+    static bool startsBefore(const Schedule & a, const int t)
+    {
+      return a.s_start < t;
+    }
+
+    //ROOM FUNCTION
+    //Description: Makes room for one more schedule, first by moving the
+    //schedules down over expired slots, then by moving to a larger block.
+    void makeRoom(ScheduleArena & arena)
+    {
+      if (t_head > 0)
+      {
+        Schedule* plan = arena.at(t_block);
+        copy(plan + t_head, plan + t_size, plan);
+        t_size -= t_head;
+        t_head = 0;
+        return;
+      }
+      int cap = t_cap > 0 ? 2*t_cap : 4;
+      int block = arena.allocate(cap); //May move the arena's slots
+      if (t_size > 0)
+      {
+        copy(arena.at(t_block), arena.at(t_block) + t_size,
+             arena.at(block));
+      }
+      if (t_block >= 0)
+      {
+        arena.release(t_block, t_cap);
+      }
+      t_block = block;
+      t_cap = cap;
+      return;
+    }
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    Timeline(){ clear(); }
+
+    //OVERLAP FUNCTION
+    //Description: Tests if the period [sta, end) overlaps any schedule.
+    //Missions usually arrive in order of start time, so the last schedule
+    //is checked directly before falling back to a binary search.
+    bool overlaps(const ScheduleArena & arena, const int sta,
+                  const int end)const
+    {
+      if (t_size == t_head)
+      {
+        return false;
+      }
+      const Schedule* first = arena.at(t_block) + t_head;
+      const Schedule* last = arena.at(t_block) + t_size - 1;
+      if (last->s_start < end) //Fast path, the last schedule is the latest
+      { //one starting before end.
+        return sta < last->s_end;
+      }
+      const Schedule* it = lower_bound(first, last + 1, end, startsBefore);
+      if (it == first) //Nothing starts before end
+      {
+        return false;
+      }
+      --it; //Latest schedule starting before end
+      return sta < it->s_end;
+    }
+
+    //INSERT FUNCTION
+    //Description: Adds the period [sta, end) to the timeline, keeping it
+    //sorted. Appending is constant time for missions that arrive in order.
+    void insert(ScheduleArena & arena, const int sta, const int end)
+    {
+      if (t_size == t_cap)
+      {
+        makeRoom(arena);
+      }
+      Schedule entry(sta, end);
+      Schedule* first = arena.at(t_block) + t_head;
+      Schedule* last = arena.at(t_block) + t_size;
+      if (first == last || !before(entry, *(last - 1)))
+      {
+        *last = entry;
+        t_last_end = end;
+      }
+      else
+      {
+        Schedule* pos = upper_bound(first, last, entry, before);
+        copy_backward(pos, last, last + 1);
+        *pos = entry;
+      }
+      t_size++;
+      return;
+    }
+
+    //CLEAR FUNCTION
+    //Description: Removes every schedule in a single step. The block is
+    //given up, to be reclaimed when the arena is rewound.
+    void clear()
+    {
+      t_block = -1;
+      t_cap = 0;
+      t_head = 0;
+      t_size = 0;
+      t_last_end = INT_MIN;
+    }
+
+    //EXPIRE FUNCTION
+    //Description: Removes every schedule ending at or before t. They can't
+    //overlap a period starting at or after t. Since ends are sorted like
+    //starts, these schedules are a prefix of the timeline, and are dropped
+    //by moving t_head past them.
+    void expire(const ScheduleArena & arena, const int t)
+    {
+      const Schedule* plan = (t_block >= 0) ? arena.at(t_block) : NULL;
+      while (t_head < t_size && plan[t_head].s_end <= t)
+      {
+        t_head++;
+      }
+      if (t_head == t_size)
+      {
+        t_head = 0;
+        t_size = 0;
+        t_last_end = INT_MIN;
+      }
+      return;
+    }
+
+    //SHIFT FUNCTION
+    //Description: Moves every schedule delta time units earlier.
+    void shift(ScheduleArena & arena, const int delta)
+    {
+      for (int i = t_head; i < t_size; i++)
+      {
+        arena.at(t_block)[i].s_start -= delta;
+        arena.at(t_block)[i].s_end -= delta;
+      }
+      if (t_last_end != INT_MIN)
+      {
+        t_last_end -= delta;
+      }
+      return;
+    }
+
+    //LATEST END FUNCTION
+    //Description: Returns the latest end time of any schedule, or INT_MIN
+    //if there are none. No period starting at or after it can overlap.
+    int latestEnd()const{ return t_last_end; }
+
+    //ACCESSOR FUNCTIONS
+    int size()const{ return t_size - t_head; }
+    const Schedule* first(const ScheduleArena & arena)const
+    {
+      return (t_size > t_head) ? arena.at(t_block) + t_head : NULL;
+    }
+
+};
+
 ////////////
 ///SENSOR///
 ////////////
@@ -136,21 +805,38 @@ class Sensor
 {
   private:
     int m_energy; //Energy level of sensor
+    int m_init_energy; //Energy level the sensor starts with
     float m_sx; //Sensor's X coordinate
     float m_sy; //Sensor's Y coordinate
     int s_num_assigned; //Stores amount of missions sensor was assigned to
-    vector<Schedule> time_plan; //Stores the time that the sensor is busy
-    //on missions. Used to evaluate if new missions can be accepted without
-    //overlapping with other missions.
+    Timeline time_plan; //Stores the time that the sensor is busy on
+    //missions. Used to evaluate if new missions can be accepted without
+    //overlapping with other missions. Its schedules are kept in the
+    //owning Network's arena, which is passed to every function using them.
     
   public:
   
-    //DEFAULT CONSTRUCTOR
-    Sensor()
+    //CONSTRUCTOR
+    //Description: Places the sensor at random within an AoI of aoi_w by
+    //aoi_h.
+    Sensor(RandGen & rng, int aoi_w, int aoi_h)
+    {
+      m_energy = 1000; //Generated sensors begin with 1000 energy units
+      m_init_energy = m_energy;
+      place(aoi_w, m_sx, rng); //Generates a valid x-coordinate on (0, aoi_w)
+      place(aoi_h, m_sy, rng); //Generates a valid y-coordinate on (0, aoi_h)
+      s_num_assigned = 0;
+    }
+
+    //CONSTRUCTOR
+    //Description: Builds a sensor at a known position, starting with the
+    //given energy level.
+    Sensor(const float x, const float y, const int energy)
     {
-      m_energy = 1000; //All sensors begin with 1000 energy units
-      place(AOI_W, m_sx); //Generates a valid x-coordinate on (0, AOI_W)
-      place(AOI_H, m_sy); //Generates a valid y-coordinate on (0, AOI_H)
+      m_energy = energy;
+      m_init_energy = energy;
+      m_sx = x;
+      m_sy = y;
       s_num_assigned = 0;
     }
     
@@ -158,330 +844,5779 @@ class Sensor
     //Description: Used to see if a mission can fit into the schedule of
     //a sensor. Also checks to see if sensor is within range and has enough
     //energy.
-    bool isSchedulable(const Mission & task)
+    bool isSchedulable(const Mission & task,
+                       const ScheduleArena & arena)const
     {
-      int res_sta = 0; //Start time restriction
-      int res_end = 0; //End time restriction
-      int sta = task.getSTART(); //Stores mission start time
-      int end = task.getEND();   //Stores mission end time
-      int e_cost = end - sta; //Calculates energy cost
-      
+      SNMS_COUNT(C_IS_SCHEDULABLE, 1);
+      int e_cost = task.getEND() - task.getSTART(); //Calculates energy cost
       if (m_energy >= e_cost && task.inRange(m_sx, m_sy))
       { //If there is enough energy and the sensor is in range
-        for (int i = 0; i < s_num_assigned; i++) //Tests for overlap with
-        { //previous schedules.
-          res_sta = time_plan[i].s_start;
-          res_end = time_plan[i].s_end;
-          //Res_sta and res_end form the interval over which a previous
-          //mission occurs. Therefore, sta and end cannot overlap with
-          //this interval if the mission is to be assignable.
-          if (sta < res_end && end > res_sta) //If the incoming mission
-          { //overlaps with a restricted boundary
-            return false;
-          }
-        }  
-        return true;
+        return isFree(task.getSTART(), task.getEND(), arena);
       }
       else
       {
         return false;
       }
     }
+
+    //FREE FUNCTION
+    //Description: Tests if the interval [sta, end) fits into the sensor's
+    //time_plan without overlapping any previously scheduled mission.
+    bool isFree(const int sta, const int end,
+                const ScheduleArena & arena)const
+    {
+      return !time_plan.overlaps(arena, sta, end);
+    }
     
     //ENSCHEDULE FUNCTION
     //Description: Used to see if a sensor is capable of being assigned to
     //a mission, and if it is, assigns it to that mission.
-    void enschedule(Mission & task)
+    void enschedule(Mission & task, ScheduleArena & arena)
     {
-      if(isSchedulable(task)) //Ensures that mission can be assigned
+      if(isSchedulable(task, arena)) //Ensures that mission can be assigned
       {
-        Schedule* temp = new Schedule(task.getSTART(), task.getEND());
-        time_plan.push_back(*temp); //Adds schedule to sensor's time_plan
+        time_plan.insert(arena, task.getSTART(), task.getEND());
         s_num_assigned++; //Increments amount of missions assigned
         int e_cost = task.getEND() - task.getSTART();
         m_energy = m_energy - e_cost;
-        delete temp;
-        temp = NULL;
       }      
       return;
     }
 
     //RESET FUNCTION
-    //Description: Resets a sensor.
+    //Description: Resets a sensor. Its schedules are dropped, and their
+    //slots are reclaimed when the arena is rewound.
     void resetSensor()
     {
-      m_energy = 1000;
-      for (int k = 0; k < s_num_assigned; k++)
+      m_energy = m_init_energy;
+      time_plan.clear();
+      s_num_assigned = 0;
+    }
+
+    //EXPIRE FUNCTION
+    //Description: Forgets every schedule ending at or before t. Only safe
+    //once no mission starting before t will be offered to the sensor.
+    void expireSchedules(const int t, const ScheduleArena & arena)
+    {
+      time_plan.expire(arena, t);
+    }
+
+    //SHIFT FUNCTION
+    //Description: Moves every schedule delta time units earlier.
+    void shiftSchedules(const int delta, ScheduleArena & arena)
+    {
+      time_plan.shift(arena, delta);
+    }
+
+    //RESTORE FUNCTION
+    //Description: Puts a reset sensor back in a saved state, with the
+    //given energy and the count schedules at plan, in order.
+    void restore(const int energy, const Schedule* plan, const int count,
+                 ScheduleArena & arena)
+    {
+      time_plan.clear();
+      for (int k = 0; k < count; k++)
       {
-        time_plan.pop_back();
+        time_plan.insert(arena, plan[k].s_start, plan[k].s_end);
       }
-      s_num_assigned = 0;
+      s_num_assigned = count;
+      m_energy = energy;
     }
     
     //ACCESSOR FUNCTIONS
     float getSX()const{ return m_sx; }
     float getSY()const{ return m_sy; }
     int getENERGY()const{ return m_energy; }
+    int getBUSYUNTIL()const{ return time_plan.latestEnd(); }
+    int getSCHEDCOUNT()const{ return time_plan.size(); }
+    const Schedule* getSCHEDULES(const ScheduleArena & arena)const
+    {
+      return time_plan.first(arena);
+    }
 
 };
-    
-/////////////
-///NETWORK///
-/////////////
 
-class Network
-{
+//////////////////
+///ENERGY_INDEX///
+//////////////////
+
+//This object counts how many sensors sit at each energy level, in a
+//Fenwick tree with one slot per level. Moving a sensor between levels,
+//counting the sensors below some level, and finding an energy percentile
+//all take logarithmic time, so a network's health can be read after every
+//mission without scanning its sensors. The tree grows, by doubling, when a
+//sensor arrives with more energy than any level it holds.
+
+struct HealthPoint
+{
+  int low_energy; //Sensors that can no longer complete a mission
+  int median_energy; //Median energy level across the sensors
+};
+
+class EnergyIndex
+{
+  private:
+    vector<int> f_count; //Number of sensors at each energy level
+    vector<int> f_tree; //Fenwick tree over f_count, indexed from 1
+    int f_total; //Number of sensors held
+
+    //UPDATE FUNCTION
+    //Description: Adds delta sensors at the given level, which must be
+    //held by the tree.
+    void update(const int level, const int delta)
+    {
+      int size = static_cast<int>(f_count.size());
+      f_count[level] += delta;
+      for (int i = level + 1; i <= size; i += i & -i)
+      {
+        f_tree[i] += delta;
+      }
+      return;
+    }
+
+    //REBUILD FUNCTION
+    //Description: Resizes the tree to hold levels up to top, rebuilding it
+    //from f_count in linear time.
+    void rebuild(const int top)
+    {
+      int size = top + 1;
+      f_count.resize(size, 0);
+      f_tree.assign(size + 1, 0);
+      for (int i = 1; i <= size; i++)
+      {
+        f_tree[i] += f_count[i - 1];
+        int parent = i + (i & -i);
+        if (parent <= size)
+        {
+          f_tree[parent] += f_tree[i];
+        }
+      }
+      return;
+    }
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    EnergyIndex(){ f_total = 0; }
+
+    //CLEAR FUNCTION
+    //Description: Removes every sensor, keeping the levels allocated.
+    void clear()
+    {
+      fill(f_count.begin(), f_count.end(), 0);
+      fill(f_tree.begin(), f_tree.end(), 0);
+      f_total = 0;
+    }
+
+    //INSERT FUNCTION
+    //Description: Adds a sensor at the given energy level. Returns false,
+    //leaving the index unchanged, if the level is negative.
+    bool insert(const int energy)
+    {
+      if (energy < 0)
+      {
+        return false;
+      }
+      int size = static_cast<int>(f_count.size());
+      if (energy >= size)
+      {
+        rebuild(max(energy, 2*size - 1));
+      }
+      update(energy, 1);
+      f_total++;
+      return true;
+    }
+
+    //MOVE FUNCTION
+    //Description: Moves a sensor from one energy level to another. Returns
+    //false, leaving the index unchanged, if either level is negative or
+    //from holds no sensor.
+    bool move(const int from, const int to)
+    {
+      if (from < 0 || to < 0 || from >= static_cast<int>(f_count.size()) ||
+          f_count[from] == 0)
+      {
+        return false;
+      }
+      if (to >= static_cast<int>(f_count.size()))
+      {
+        rebuild(max(to, 2*static_cast<int>(f_count.size()) - 1));
+      }
+      update(from, -1);
+      update(to, 1);
+      return true;
+    }
+
+    //COUNT BELOW FUNCTION
+    //Description: Returns the number of sensors with less than bound
+    //energy.
+    int countBelow(const int bound)const
+    {
+      int count = 0;
+      for (int i = min(bound, static_cast<int>(f_count.size())); i > 0;
+           i -= i & -i)
+      {
+        count += f_tree[i];
+      }
+      return count;
+    }
+
+    //PERCENTILE FUNCTION
+    //Description: Returns the lowest energy level that at least the
+    //fraction p of the sensors are at or below, or 0 if there are none.
+    int percentile(const double p)const
+    {
+      if (f_total == 0)
+      {
+        return 0;
+      }
+      int rank = static_cast<int>(ceil(p*f_total)); //Sensors to cover
+      rank = max(1, min(rank, f_total));
+      int size = static_cast<int>(f_count.size());
+      int step = 1;
+      while (step*2 <= size)
+      {
+        step *= 2;
+      }
+      int pos = 0; //Levels known to hold fewer than rank sensors
+      for (; step > 0; step /= 2)
+      {
+        if (pos + step <= size && f_tree[pos + step] < rank)
+        {
+          pos += step;
+          rank -= f_tree[pos];
+        }
+      }
+      return pos;
+    }
+
+    //ACCESSOR FUNCTIONS
+    int getTOTAL()const{ return f_total; }
+
+};
+
+//////////////////
+///SENSOR_STORE///
+//////////////////
+
+//This object mirrors the fields of a Network's sensors that every range
+//and energy test reads, as one contiguous array per field. Scanning these
+//arrays touches far less memory than scanning the Sensor objects, and lets
+//the SIMD kernels test eight sensors at a time. The Network keeps each
+//entry in step with its Sensor.
+
+class SensorStore
+{
+  public:
+    vector<float> st_x; //X coordinate of each sensor
+    vector<float> st_y; //Y coordinate of each sensor
+    vector<int> st_energy; //Energy level of each sensor
+    vector<int> st_busy_until; //Latest end time in each sensor's time_plan
+    EnergyIndex st_levels; //Number of sensors at each energy level
+
+    //CLEAR FUNCTION
+    //Description: Removes every sensor from the store.
+    void clear()
+    {
+      st_x.clear();
+      st_y.clear();
+      st_energy.clear();
+      st_busy_until.clear();
+      st_levels.clear();
+    }
+
+    //ADD FUNCTION
+    //Description: Appends a sensor to the store.
+    void add(const Sensor & sensor)
+    {
+      st_x.push_back(sensor.getSX());
+      st_y.push_back(sensor.getSY());
+      st_energy.push_back(sensor.getENERGY());
+      st_busy_until.push_back(sensor.getBUSYUNTIL());
+      st_levels.insert(sensor.getENERGY());
+    }
+
+    //SYNC FUNCTION
+    //Description: Copies the changing fields of sensor i into the store.
+    void sync(const int i, const Sensor & sensor)
+    {
+      if (st_energy[i] != sensor.getENERGY())
+      {
+        st_levels.move(st_energy[i], sensor.getENERGY());
+      }
+      st_energy[i] = sensor.getENERGY();
+      st_busy_until[i] = sensor.getBUSYUNTIL();
+    }
+
+};
+
+/////////////
+///KD_TREE///
+/////////////
+
+//This object is the Network's spatial index, a k-d tree over the sensor
+//positions. Each node covers a contiguous run of k_items, and splits it at
+//the median of the wider side of its bounding box, until runs are at most
+//KD_LEAF sensors long. Coordinates are copied into k_x and k_y in the same
+//order, so a leaf's sensors can be handed straight to the selection
+//kernel. A query may use any radius: it only visits the nodes whose
+//bounding box comes within that radius of the epicenter.
+
+const int KD_LEAF = 128; //Most sensors held by a leaf
+
+class KdTree
+{
+  private:
+    struct Node
+    {
+      float x_lo, x_hi; //Bounding box of the node's sensors
+      float y_lo, y_hi;
+      int first; //First entry of k_items the node covers
+      int last; //One past the last entry
+      int left; //Children, or -1 for a leaf
+      int right;
+    };
+
+    vector<Node> k_node; //Node 0 is the root
+    vector<int> k_items; //Sensor indexes, grouped by leaf
+    vector<float> k_x; //X coordinates in the order of k_items
+    vector<float> k_y; //Y coordinates in the order of k_items
+
+    //This comparison orders sensors along one axis.
+    struct AxisLess
+    {
+      const float* c; //Coordinate of each sensor along the axis
+      bool operator()(const int a, const int b)const
+      {
+        return c[a] < c[b] || (c[a] == c[b] && a < b);
+      }
+    };
+
+    //NODE BUILD FUNCTION
+    //Description: Builds the subtree covering entries first up to last of
+    //k_items and returns its node.
+    int buildNode(const float* x, const float* y, const int first,
+                  const int last, const int depth)
+    {
+      Node node;
+      node.x_lo = node.y_lo = HUGE_VALF;
+      node.x_hi = node.y_hi = -HUGE_VALF;
+      for (int k = first; k < last; k++)
+      {
+        node.x_lo = min(node.x_lo, x[k_items[k]]);
+        node.x_hi = max(node.x_hi, x[k_items[k]]);
+        node.y_lo = min(node.y_lo, y[k_items[k]]);
+        node.y_hi = max(node.y_hi, y[k_items[k]]);
+      }
+      node.first = first;
+      node.last = last;
+      node.left = -1;
+      node.right = -1;
+      int id = static_cast<int>(k_node.size());
+      k_node.push_back(node);
+      if (last - first <= KD_LEAF || depth >= 48) //Leaves list in index order
+      {
+        sort(k_items.begin() + first, k_items.begin() + last);
+        return id;
+      }
+      AxisLess order;
+      order.c = node.x_hi - node.x_lo >= node.y_hi - node.y_lo ? x : y;
+      int mid = first + (last - first)/2;
+      nth_element(k_items.begin() + first, k_items.begin() + mid,
+                  k_items.begin() + last, order);
+      int left = buildNode(x, y, first, mid, depth + 1);
+      int right = buildNode(x, y, mid, last, depth + 1);
+      k_node[id].left = left;
+      k_node[id].right = right;
+      return id;
+    }
+
+  public:
+
+    //BUILD FUNCTION
+    //Description: Rebuilds the tree over n sensors at the passed positions.
+    void build(const float* x, const float* y, const int n)
+    {
+      k_node.clear();
+      k_items.resize(n);
+      for (int i = 0; i < n; i++)
+      {
+        k_items[i] = i;
+      }
+      if (n > 0)
+      {
+        buildNode(x, y, 0, n, 0);
+      }
+      k_x.resize(n);
+      k_y.resize(n);
+      for (int k = 0; k < n; k++)
+      {
+        k_x[k] = x[k_items[k]];
+        k_y[k] = y[k_items[k]];
+      }
+      return;
+    }
+
+    //QUERY FUNCTION
+    //Description: Writes the index of every sensor within r2 squared
+    //distance of (ex, ey) that has at least min_energy energy to out, and
+    //returns how many there are. They are grouped by leaf, each group in
+    //ascending order, and the end of every group is appended to runs.
+    int query(const float ex, const float ey, const float r2,
+              const int* energy, const int min_energy, int* out,
+              vector<int> & runs)const
+    {
+      runs.clear();
+      if (k_node.empty())
+      {
+        return 0;
+      }
+      const float reach = r2*1.0001f + 1e-6f; //Guards against rounding
+      int stack[64]; //Nodes left to visit
+      int depth = 0;
+      int found = 0;
+      stack[depth++] = 0;
+      while (depth > 0)
+      {
+        const Node & node = k_node[stack[--depth]];
+        float dx = max(max(node.x_lo - ex, ex - node.x_hi), 0.0f);
+        float dy = max(max(node.y_lo - ey, ey - node.y_hi), 0.0f);
+        if (dx*dx + dy*dy > reach) //The box is out of range
+        {
+          continue;
+        }
+        if (node.left < 0)
+        {
+          int hits = selectInRange(&k_x[0] + node.first, &k_y[0] + node.first,
+                                   energy, &k_items[0] + node.first, 0,
+                                   node.last - node.first, ex, ey, r2,
+                                   min_energy, out + found);
+          if (hits > 0)
+          {
+            found += hits;
+            runs.push_back(found);
+          }
+          continue;
+        }
+        stack[depth++] = node.right;
+        stack[depth++] = node.left;
+      }
+      return found;
+    }
+
+    //MEMORY FUNCTION
+    //Description: Returns the number of bytes held by the tree's arrays.
+    size_t memoryBytes()const
+    {
+      return sizeof(Node)*k_node.capacity() +
+             sizeof(int)*k_items.capacity() +
+             sizeof(float)*(k_x.capacity() + k_y.capacity());
+    }
+};
+
+///////////////////////
+///ELIGIBILITY_GRAPH///
+///////////////////////
+
+//Sensors and missions never move during a trial, so which sensors are in
+//range of which missions can be worked out once. This object stores that
+//relation as compressed sparse rows in both directions. Row m of the
+//forward map lists the sensors in range of mission m in ascending order,
+//and row s of the reverse map lists the missions in range of sensor s in
+//ascending order. A Network with a graph attached reads a mission's row
+//instead of running a range query, leaving only the energy and time_plan
+//checks to be done when scheduling.
+
+class Network;
+
+class EligibilityGraph
+{
+  private:
+    vector<int> g_row_start; //Offset of each mission's row in g_sensor
+    vector<int> g_sensor; //Sensors in range, grouped by mission
+    vector<int> g_col_start; //Offset of each sensor's row in g_mission
+    vector<int> g_mission; //Missions in range, grouped by sensor
+
+  public:
+
+    //BUILD FUNCTION
+    //Description: Rebuilds the graph for the passed Network and missions.
+    //Also sets every mission's index to its position in the list.
+    void build(Network & net, vector<Mission> & list);
+
+    //ACCESSOR FUNCTIONS
+    int getMISSIONS()const{ return static_cast<int>(g_row_start.size()) - 1; }
+    int getSENSORS()const{ return static_cast<int>(g_col_start.size()) - 1; }
+    int getEDGES()const{ return static_cast<int>(g_sensor.size()); }
+    int sensorCount(const int m)const
+    {
+      return g_row_start[m + 1] - g_row_start[m];
+    }
+    const int* sensorsOf(const int m)const{ return &g_sensor[g_row_start[m]]; }
+    int missionCount(const int s)const
+    {
+      return g_col_start[s + 1] - g_col_start[s];
+    }
+    const int* missionsOf(const int s)const
+    {
+      return &g_mission[g_col_start[s]];
+    }
+
+    //MEMORY FUNCTION
+    //Description: Returns the number of bytes the graph's entries take.
+    //Sizes rather than capacities are counted, since a workspace's graph
+    //keeps the capacity of the largest graph its thread has built.
+    size_t memoryBytes()const
+    {
+      return sizeof(int)*(g_row_start.size() + g_sensor.size() +
+                          g_col_start.size() + g_mission.size());
+    }
+
+};
+
+/////////////////////////
+///SCHEDULING_POLICIES///
+/////////////////////////
+
+//A scheduling policy decides which sensors serve a mission. Network::
+//schedule gathers every sensor that could be assigned to the mission and
+//runs the policy's two steps on them:
+//  rank   - moves the num_sensors sensors to use to the front of the list,
+//           or returns false to leave the mission unsatisfied
+//  commit - is told which sensors were assigned
+//Policies are template parameters rather than virtual classes, so each
+//one gets its own copy of the loop with its steps inlined. PolicyBase
+//supplies the steps a policy leaves out.
+
+struct PolicyBase
+{
+  void commit(const int* /*sensors*/, const int /*count*/,
+              const Mission & /*task*/){}
+};
+
+//This comparison orders sensors by energy, most first, and then by
+//index. It is the order in which the energy based algorithms have
+//always picked sensors, since they only replace their best pick when
+//a later sensor has strictly more energy.
+struct MoreEnergy
+{
+  const int* energy; //Energy of each sensor
+  bool operator()(const int a, const int b)const
+  {
+    return energy[a] > energy[b] || (energy[a] == energy[b] && a < b);
+  }
+};
+
+//PICK BEST FUNCTION
+//Description: Moves the num_sensors best sensors of a list to its front,
+//sorted, using a partial selection so the rest are left unsorted.
+template <class Order>
+void pickBest(vector<int> & list, const int num_sensors, const Order & order)
+{
+  if (num_sensors <= 0)
+  {
+    return;
+  }
+  if (static_cast<int>(list.size()) > num_sensors)
+  {
+    nth_element(list.begin(), list.begin() + (num_sensors - 1), list.end(),
+                order);
+  }
+  sort(list.begin(), list.begin() + num_sensors, order);
+  return;
+}
+
+//The Random Algorithm's policy picks sensors uniformly at random, without
+//replacement, using a partial Fisher-Yates shuffle.
+struct RandomPolicy : PolicyBase
+{
+  RandGen & rng; //Generator the picks are drawn from
+
+  RandomPolicy(RandGen & gen) : rng(gen) {}
+
+  bool rank(vector<int> & list, const int num_sensors,
+            const Mission & /*task*/, const SensorStore & /*store*/)
+  {
+    int eligible = static_cast<int>(list.size());
+    for (int k = 0; k < num_sensors; k++)
+    {
+      SNMS_COUNT(C_RANDOM_DRAW, 1);
+      int pick = k + rng.next()%(eligible - k); //Choose random sensor
+      swap(list[k], list[pick]); //among those not yet picked
+    }
+    return true;
+  }
+};
+
+//The Online Algorithm's policy picks the sensors with the most energy.
+//If used isn't NULL, every sensor assigned is appended to it.
+struct MostEnergyPolicy : PolicyBase
+{
+  vector<int>* used; //Sensors assigned so far, if recorded
+
+  MostEnergyPolicy(vector<int>* record = NULL) : used(record) {}
+
+  bool rank(vector<int> & list, const int num_sensors,
+            const Mission & /*task*/, const SensorStore & store)
+  {
+    MoreEnergy order;
+    order.energy = store.st_energy.data();
+    pickBest(list, num_sensors, order);
+    return true;
+  }
+
+  void commit(const int* sensors, const int count, const Mission & /*task*/)
+  {
+    if (used != NULL)
+    {
+      used->insert(used->end(), sensors, sensors + count);
+    }
+  }
+};
+
+//The best fit policy picks the sensors with the least energy that can
+//still cover the mission, keeping fuller sensors for later missions.
+struct LeastEnergyPolicy : PolicyBase
+{
+  struct LessEnergy
+  {
+    const int* energy; //Energy of each sensor
+    bool operator()(const int a, const int b)const
+    {
+      return energy[a] < energy[b] || (energy[a] == energy[b] && a < b);
+    }
+  };
+
+  bool rank(vector<int> & list, const int num_sensors,
+            const Mission & /*task*/, const SensorStore & store)
+  {
+    LessEnergy order;
+    order.energy = store.st_energy.data();
+    pickBest(list, num_sensors, order);
+    return true;
+  }
+};
+
+//The nearest policy picks the sensors closest to the mission's epicenter.
+struct NearestPolicy : PolicyBase
+{
+  struct Closer
+  {
+    const float* x; //X coordinate of each sensor
+    const float* y; //Y coordinate of each sensor
+    float ex; //Epicenter of the mission
+    float ey;
+    bool operator()(const int a, const int b)const
+    {
+      float da = (x[a] - ex)*(x[a] - ex) + (y[a] - ey)*(y[a] - ey);
+      float db = (x[b] - ex)*(x[b] - ex) + (y[b] - ey)*(y[b] - ey);
+      return da < db || (da == db && a < b);
+    }
+  };
+
+  bool rank(vector<int> & list, const int num_sensors, const Mission & task,
+            const SensorStore & store)
+  {
+    Closer order;
+    order.x = store.st_x.data();
+    order.y = store.st_y.data();
+    order.ex = task.getEX();
+    order.ey = task.getEY();
+    pickBest(list, num_sensors, order);
+    return true;
+  }
+};
+    
+//These are the buffers a range query and candidate selection work in.
+//The Network keeps one for its own queries. Threads that evaluate
+//missions on a Network at the same time each bring their own.
+struct SelectScratch
+{
+  vector<int> cand; //Sensors in range of a mission
+  vector<int> scratch; //Output buffer for the selection kernel
+  vector<int> chosen; //Sensors picked by the last candidate selection
+  vector<int> runs; //Ends of the sorted runs a k-d tree query returned
+  vector<uint64_t> bits; //All clear between uses, one bit per sensor
+};
+
+/////////////
+///NETWORK///
+/////////////
+
+class Network
+{
   private:
     int m_num; //Number of sensors
     int m_mission_count; //Number of missions processed by Network
     int m_mission_satis; //Number of missions satisfied by Network
     vector<Sensor> m_sensor; //Vector of sensors
-    
-  public:
-    
-    //DEFAULT CONSTRUCTOR
-    Network(int sensor_count)
+    SensorStore m_store; //Contiguous copy of the sensors' hot fields
+    ScheduleArena m_arena; //Holds the schedules of every sensor
+
+    int m_aoi_w; //Largest X-Coord within the Network's Area of Interest
+    int m_aoi_h; //Largest Y-Coord within the Network's Area of Interest
+
+    bool m_use_index; //If false, range queries fall back to a full scan
+    KdTree m_tree; //Spatial index over the sensor positions
+    SelectScratch m_work; //Buffers for the Network's own queries
+    const EligibilityGraph* m_graph; //Precomputed ranges, if attached
+    vector<HealthPoint>* m_health; //Health after each mission, if tracked
+    int m_health_dura; //Energy below which a sensor counts as low energy
+
+    //HEALTH RECORDING FUNCTION
+    //Description: Appends the network's current health to the tracked
+    //curve, if there is one.
+    void recordHealth()
+    {
+      if (m_health != NULL)
+      {
+        HealthPoint point;
+        point.low_energy = m_store.st_levels.countBelow(m_health_dura);
+        point.median_energy = m_store.st_levels.percentile(0.5);
+        m_health->push_back(point);
+      }
+      return;
+    }
+
+
+    //BUILD STORE FUNCTION
+    //Description: Rebuilds the SensorStore from the Sensor objects.
+    void buildStore()
+    {
+      m_store.clear();
+      for (int i = 0; i < m_num; i++)
+      {
+        m_store.add(m_sensor[i]);
+      }
+      return;
+    }
+
+    //BUILD INDEX FUNCTION
+    //Description: Rebuilds the spatial index from the SensorStore's
+    //positions.
+    void buildIndex()
+    {
+      m_tree.build(m_store.st_x.data(), m_store.st_y.data(), m_num);
+      return;
+    }
+
+    //GATHER FUNCTION
+    //Description: Fills w.cand with the indexes of every sensor within
+    //range of a mission that has at least min_energy energy, in ascending
+    //order. Only the k-d tree leaves within the mission's range are
+    //visited unless the index has been disabled, in which case every
+    //sensor is tested. Both paths return the same list.
+    void gatherInRange(const Mission & task, const int min_energy,
+                       SelectScratch & w)const
+    {
+      const float rad = task.getRAD(); //Mission's range
+      const float r2 = rad*rad; //Squared range, as used by inRange
+      const int* energy = m_store.st_energy.data();
+      int found = 0; //Number of sensors written to w.scratch
+      if (m_graph != NULL && task.getINDEX() >= 0) //Range is precomputed
+      {
+        const int* row = m_graph->sensorsOf(task.getINDEX());
+        int row_len = m_graph->sensorCount(task.getINDEX());
+        w.cand.clear();
+        for (int j = 0; j < row_len; j++)
+        {
+          if (energy[row[j]] >= min_energy)
+          {
+            w.cand.push_back(row[j]);
+          }
+        }
+        return;
+      }
+      if (static_cast<int>(w.scratch.size()) < m_num)
+      {
+        w.scratch.resize(m_num);
+      }
+      if (!m_use_index)
+      {
+        found = selectInRange(m_store.st_x.data(), m_store.st_y.data(),
+                              energy, NULL, 0, m_num, task.getEX(),
+                              task.getEY(), r2, min_energy, w.scratch.data());
+        w.cand.assign(w.scratch.begin(), w.scratch.begin() + found);
+        return;
+      }
+      found = m_tree.query(task.getEX(), task.getEY(), r2, energy, min_energy,
+                           w.scratch.data(), w.runs);
+      orderFound(found, w);
+      return;
+    }
+
+    //ORDER FUNCTION
+    //Description: Moves the found sensors of a k-d tree query from
+    //w.scratch to w.cand in ascending order. Large results are set in a
+    //bitmap and read back word by word; smaller ones have their sorted
+    //runs merged pairwise, which costs found times log2 of the run count.
+    void orderFound(const int found, SelectScratch & w)const
+    {
+      w.cand.resize(found);
+      if (found > m_num/512 && found > 64) //Cheaper to scan a bitmap
+      {
+        size_t words = (static_cast<size_t>(m_num) + 63)/64;
+        if (w.bits.size() < words)
+        {
+          w.bits.resize(words, 0);
+        }
+        int lo = m_num; //Lowest and highest sensor found
+        int hi = 0;
+        for (int k = 0; k < found; k++)
+        {
+          int s = w.scratch[k];
+          w.bits[s >> 6] |= uint64_t(1) << (s & 63);
+          lo = min(lo, s);
+          hi = max(hi, s);
+        }
+        int k = 0;
+        for (int word = lo >> 6; word <= hi >> 6; word++)
+        {
+          uint64_t b = w.bits[word];
+          w.bits[word] = 0;
+          while (b != 0)
+          {
+            w.cand[k++] = word*64 + __builtin_ctzll(b);
+            b &= b - 1;
+          }
+        }
+        return;
+      }
+      int* src = w.scratch.data();
+      int* dst = w.cand.data();
+      vector<int> & runs = w.runs;
+      while (runs.size() > 1)
+      {
+        size_t kept = 0; //Runs left after this pass
+        int start = 0;
+        for (size_t r = 0; r < runs.size(); r += 2)
+        {
+          if (r + 1 < runs.size())
+          {
+            merge(src + start, src + runs[r], src + runs[r], src + runs[r + 1],
+                  dst + start);
+            start = runs[r + 1];
+          }
+          else
+          {
+            copy(src + start, src + runs[r], dst + start);
+            start = runs[r];
+          }
+          runs[kept++] = start;
+        }
+        runs.resize(kept);
+        swap(src, dst);
+      }
+      if (src != w.cand.data())
+      {
+        copy(src, src + found, w.cand.data());
+      }
+      return;
+    }
+
+    //ACCEPT FUNCTION
+    //Description: Same as Sensor::isSchedulable for sensor i, minus the
+    //range test, which the caller has already done. Reads energy and the
+    //latest end time from the SensorStore, and only searches the sensor's
+    //time_plan if the mission starts before that end time.
+    bool accepts(const int i, const Mission & task)const
+    {
+      SNMS_COUNT(C_IS_SCHEDULABLE, 1);
+      int sta = task.getSTART();
+      int end = task.getEND();
+      if (m_store.st_energy[i] < end - sta)
+      {
+        return false;
+      }
+      return m_store.st_busy_until[i] <= sta ||
+             m_sensor[i].isFree(sta, end, m_arena);
+    }
+
+    //ELIGIBLE GATHER FUNCTION
+    //Description: Fills w.chosen with every sensor that could be assigned
+    //to a mission, in ascending order, and returns how many there are.
+    int gatherEligible(const Mission & task, SelectScratch & w)const
+    {
+      gatherInRange(task, task.getEND() - task.getSTART(), w);
+      w.chosen.clear();
+      for (size_t j = 0; j < w.cand.size(); j++)
+      {
+        if (accepts(w.cand[j], task))
+        {
+          w.chosen.push_back(w.cand[j]);
+        }
+      }
+      return static_cast<int>(w.chosen.size());
+    }
+
+    //CANDIDATE SELECTION FUNCTION
+    //Description: Gathers every sensor that could be assigned to a mission
+    //in a single pass, and returns how many there are. If there are at
+    //least num_sensors of them, the num_sensors with the most energy are
+    //left in w.chosen, most energy first, ties going to the lower index.
+    //This is the same set the old approach found by rescanning the
+    //sensors once per pick. A partial selection is used, so only the
+    //chosen sensors are fully sorted.
+    int selectCandidates(const Mission & task, const int num_sensors,
+                         SelectScratch & w)const
+    {
+      int eligible = gatherEligible(task, w);
+      if (num_sensors <= 0 || eligible < num_sensors)
+      {
+        return eligible;
+      }
+      MoreEnergy order;
+      order.energy = m_store.st_energy.data();
+      pickBest(w.chosen, num_sensors, order);
+      w.chosen.resize(num_sensors);
+      return eligible;
+    }
+
+    //ASSIGN FUNCTION
+    //Description: Enschedules sensor i and updates its SensorStore entry.
+    void assign(const int i, Mission & task)
+    {
+      m_sensor[i].enschedule(task, m_arena);
+      m_store.sync(i, m_sensor[i]);
+      return;
+    }
+    
+  public:
+    
+    //DEFAULT CONSTRUCTOR
+    Network()
+    {
+      m_mission_count = 0;
+      m_mission_satis = 0;
+      m_num = 0;
+      m_use_index = true;
+      m_graph = NULL;
+      m_health = NULL;
+      m_health_dura = 0;
+      m_aoi_w = AOI_W;
+      m_aoi_h = AOI_H;
+      buildStore();
+      buildIndex();
+    }
+
+    //CONSTRUCTOR
+    Network(int sensor_count, RandGen & rng)
+    {
+      m_mission_count = 0;
+      m_mission_satis = 0;
+      m_num = sensor_count;
+      m_use_index = true;
+      m_graph = NULL;
+      m_health = NULL;
+      m_health_dura = 0;
+      m_aoi_w = AOI_W;
+      m_aoi_h = AOI_H;
+      m_sensor.reserve(sensor_count);
+      for (int i = 0; i < sensor_count; i++) //Builds each sensor in place
+      {
+        m_sensor.emplace_back(rng, m_aoi_w, m_aoi_h);
+      }
+      buildStore();
+      buildIndex();
+    }
+    
+    //CLEAR FUNCTION
+    //Description: Clears a Network completely, removing all sensors. The
+    //memory they used is kept, to be reused by the next sensors added.
+    void clearNetwork()
+    {
+      m_mission_count = 0;
+      m_mission_satis = 0;
+      m_sensor.clear();
+      m_arena.rewind();
+      m_num = 0;
+      m_graph = NULL;
+      buildStore();
+      buildIndex();
+    }
+   
+    //RESET FUNCTION
+    //Description: Resets a Network back to its original state. This
+    //retains all sensors used, and resets all of them as well. Every
+    //schedule is freed at once by rewinding the arena.
+    void resetNetwork()
+    {
+      m_mission_count = 0;
+      m_mission_satis = 0;
+      for (int i = 0; i < m_num; i++)
+      {
+        m_sensor[i].resetSensor();
+        m_store.sync(i, m_sensor[i]);
+      }
+      m_arena.rewind();
+      return;
+    }
+
+    //STATE WRITING FUNCTION
+    //Description: Writes what scheduling has changed in the Network: the
+    //mission counters, then every sensor's energy, schedule count and
+    //schedules, as arrays of 32-bit ints. Positions aren't written, since
+    //the sensors are rebuilt from their Scenario.
+    void writeState(ostream & out)const
+    {
+      vector<int32_t> words; //Counters, energies, then schedule counts
+      words.reserve(4 + 2*m_num);
+      int total = 0; //Schedules held by every sensor
+      for (int i = 0; i < m_num; i++)
+      {
+        total += m_sensor[i].getSCHEDCOUNT();
+      }
+      words.push_back(m_num);
+      words.push_back(m_mission_count);
+      words.push_back(m_mission_satis);
+      words.push_back(total);
+      for (int i = 0; i < m_num; i++)
+      {
+        words.push_back(m_sensor[i].getENERGY());
+      }
+      for (int i = 0; i < m_num; i++)
+      {
+        words.push_back(m_sensor[i].getSCHEDCOUNT());
+      }
+      out.write(reinterpret_cast<const char*>(words.data()),
+                words.size()*sizeof(int32_t));
+      for (int i = 0; i < m_num; i++)
+      {
+        out.write(reinterpret_cast<const char*>(
+                    m_sensor[i].getSCHEDULES(m_arena)),
+                  m_sensor[i].getSCHEDCOUNT()*sizeof(Schedule));
+      }
+      return;
+    }
+
+    //STATE READING FUNCTION
+    //Description: Resets the Network and restores the state written by
+    //writeState. Returns false, leaving the Network reset, if the state
+    //is damaged or was written for a different number of sensors. Every
+    //count is checked against the bytes left in the stream before any
+    //space is set aside for it.
+    bool readState(istream & in)
+    {
+      resetNetwork();
+      int32_t head[4]; //Sensors, missions attempted and satisfied, schedules
+      if (!in.read(reinterpret_cast<char*>(head), sizeof(head)) ||
+          head[0] != m_num || head[1] < 0 || head[2] < 0 ||
+          head[2] > head[1] || head[3] < 0)
+      {
+        return false;
+      }
+      long long needed = 2LL*m_num*static_cast<long long>(sizeof(int32_t)) +
+        static_cast<long long>(head[3])*
+        static_cast<long long>(sizeof(Schedule)); //Bytes still to come
+      streampos here = in.tellg(); //Start of the energies
+      in.seekg(0, ios::end);
+      streampos end = in.tellg(); //End of the stream
+      in.seekg(here);
+      if (here < 0 || end < here || !in ||
+          static_cast<long long>(end - here) < needed)
+      {
+        return false;
+      }
+      vector<int32_t> words(2*m_num); //Energies, then schedule counts
+      if (!in.read(reinterpret_cast<char*>(words.data()),
+                   words.size()*sizeof(int32_t)))
+      {
+        return false;
+      }
+      long long total = 0;
+      bool valid = true; //Set if every count could have been written
+      for (int i = 0; i < m_num; i++)
+      {
+        total += words[m_num + i];
+        valid = valid && words[m_num + i] >= 0 &&
+                words[m_num + i] <= head[1];
+      }
+      if (!valid || total != head[3])
+      {
+        return false;
+      }
+      vector<Schedule> plan(head[3]); //Every sensor's schedules, in order
+      if (!in.read(reinterpret_cast<char*>(plan.data()),
+                   plan.size()*sizeof(Schedule)))
+      {
+        return false;
+      }
+      int first = 0; //First schedule of the next sensor
+      for (int i = 0; i < m_num; i++)
+      {
+        m_sensor[i].restore(words[i], plan.data() + first, words[m_num + i],
+                            m_arena);
+        m_store.sync(i, m_sensor[i]);
+        first += words[m_num + i];
+      }
+      m_mission_count = head[1];
+      m_mission_satis = head[2];
+      return true;
+    }
+    
+    //GEOMETRY FUNCTION
+    //Description: Sets the Network's AoI, which sensors it generates are
+    //placed in. The spatial index adapts to the sensors themselves, so
+    //missions of any range can be queried.
+    void setGeometry(const int aoi_w, const int aoi_h)
+    {
+      m_aoi_w = aoi_w;
+      m_aoi_h = aoi_h;
+      return;
+    }
+
+    //EXPIRE FUNCTION
+    //Description: Forgets every schedule ending at or before t, so the
+    //sensors only keep the missions that are still running. Only safe
+    //once no mission starting before t will be assigned.
+    void expireSchedules(const int t)
+    {
+      for (int i = 0; i < m_num; i++)
+      {
+        m_sensor[i].expireSchedules(t, m_arena);
+        m_store.sync(i, m_sensor[i]);
+      }
+      return;
+    }
+
+    //SHIFT FUNCTION
+    //Description: Moves every schedule delta time units earlier, so that
+    //missions can keep being numbered from a later origin.
+    void shiftTime(const int delta)
+    {
+      for (int i = 0; i < m_num; i++)
+      {
+        m_sensor[i].shiftSchedules(delta, m_arena);
+        m_store.sync(i, m_sensor[i]);
+      }
+      return;
+    }
+
+    //COPY SENSORS FUNCTION
+    //Description: Adds copies of the first sensor_count sensors in source
+    //to the network. Resets Network automatically.
+    void addSensors(const vector<Sensor> & source, const int sensor_count)
+    {
+      resetNetwork();
+      m_sensor.insert(m_sensor.end(), source.begin(),
+                      source.begin() + sensor_count);
+      m_num = m_num + sensor_count;
+      buildStore();
+      buildIndex();
+      return;
+    }
+
+    //ADD SENSORS FUNCTION
+    //Description: Adds additional sensors to the network. Resets Network
+    //automatically. Sensors are placed using the passed generator.
+    void addSensors(const int sensor_count, RandGen & rng)
+    {
+      resetNetwork();
+      m_num = m_num + sensor_count;
+      m_sensor.reserve(m_num);
+      for (int i = 0; i < sensor_count; i++) //Builds each sensor in place
+      {
+        m_sensor.emplace_back(rng, m_aoi_w, m_aoi_h);
+      }
+      buildStore();
+      buildIndex();
+      return;
+    }
+    
+    //ELIGIBLE SENSORS FUNCTION
+    //Description: Returns every sensor that could be assigned to a
+    //mission, in ascending order. The list is only valid until the next
+    //query on this Network.
+    const vector<int> & eligibleSensors(const Mission & task)
+    {
+      gatherEligible(task, m_work);
+      return m_work.chosen;
+    }
+
+    //CHOSEN ASSIGNMENT FUNCTION
+    //Description: Attempts a mission with sensors chosen by the caller,
+    //who has checked that each one could be assigned to it. The mission
+    //is satisfied if count is at least its demand, and otherwise no
+    //sensor is assigned.
+    void assignSensors(Mission & task, const int num_sensors,
+                       const int* sensors, const int count)
+    {
+      task.attempted = true;
+      if (count >= task.demand(num_sensors))
+      {
+        for (int k = 0; k < count; k++)
+        {
+          assign(sensors[k], task);
+        }
+        m_mission_satis++;
+      }
+      m_mission_count++;
+      recordHealth();
+      return;
+    }
+
+    //SCHEDULABLE FUNCTION
+    //Description: Tests if sensor i could be assigned to a mission.
+    bool isSchedulable(const int i, const Mission & task)const
+    {
+      return m_sensor[i].isSchedulable(task, m_arena);
+    }
+
+    //ACCESSOR FUNCTIONS    
+    int getNUM(){ return m_num; }
+    int getMISSIONCOUNT(){ return m_mission_count; } 
+    int getMISSIONSATIS(){ return m_mission_satis; }
+    const Sensor & getSENSOR(const int i)const{ return m_sensor[i]; }
+    const int* getENERGIES()const{ return m_store.st_energy.data(); }
+
+    //IN RANGE FUNCTION
+    //Description: Returns the indexes of every sensor within range of a
+    //mission, in ascending order. The list is only valid until the next
+    //range query on this Network.
+    const vector<int> & sensorsInRange(const Mission & task)
+    {
+      gatherInRange(task, INT_MIN, m_work);
+      return m_work.cand;
+    }
+
+    //SPATIAL INDEX SWITCH
+    //Description: Enables or disables the k-d tree. With it disabled, every
+    //range query scans all sensors, which is useful for checking that both
+    //paths produce identical results.
+    void setSpatialIndex(const bool enabled){ m_use_index = enabled; }
+
+    //GRAPH ATTACHMENT FUNCTION
+    //Description: Makes range queries for missions with an index read the
+    //passed graph's rows instead. The graph must have been built for this
+    //Network's sensors and the list those missions belong to. Passing NULL
+    //detaches the graph.
+    void attachGraph(const EligibilityGraph* graph){ m_graph = graph; }
+
+    //COUNT SCHEDULABLE FUNCTION
+    //Description: Used to count the number of sensors that are able to
+    //satisfy the "isSchedulable" function with regards to some mission.
+    int countSched(Mission & task)
+    {
+      gatherInRange(task, task.getEND() - task.getSTART(), m_work);
+      return countCandidates(task);
+    }
+
+    //COUNT CANDIDATES FUNCTION
+    //Description: Same as countSched, but reuses the sensors already
+    //gathered into m_work.cand rather than running a new range query.
+    int countCandidates(const Mission & task)const
+    {
+      int count_sch = 0; //Used to store amount of assignable sensors
+      for (size_t j = 0; j < m_work.cand.size(); j++)
+      {
+        if (accepts(m_work.cand[j], task)) //If a sensor can be assigned
+        {
+          count_sch++; //Amount of assignable sensors incremented
+        }
+      }
+      return count_sch;
+    }
+
+    //LOW-ENERGY-SENSOR COUNTING FUNCTION
+    //Description: Returns the number of sensors that can no longer complete
+    //missions.
+    float calcLES(const int dura)const
+    {
+      //Counts the sensors with less than "dura" units of energy left
+      return m_store.st_levels.countBelow(dura);
+    }       
+
+    //ENERGY PERCENTILE FUNCTION
+    //Description: Returns the lowest energy level that at least the
+    //fraction p of the sensors are at or below.
+    int energyPercentile(const double p)const
+    {
+      return m_store.st_levels.percentile(p);
+    }
+
+    //HEALTH TRACKING FUNCTION
+    //Description: While curve isn't NULL, the network's health after
+    //every mission it is given is appended to curve. Sensors with less
+    //than dura energy count as low energy.
+    void trackHealth(const int dura, vector<HealthPoint>* curve)
+    {
+      m_health_dura = dura;
+      m_health = curve;
+      return;
+    }
+    
+    //RANDOM ASSIGNMENT FUNCTION
+    //Description: This function first gathers every sensor that can be
+    //assigned to a mission. If there are enough of them, the function
+    //picks sensors from that list at random, without replacement, until
+    //the mission has had sufficient sensors assigned, and it is marked as
+    //satisfied. Each sensor that can be assigned is equally likely to be
+    //picked, and no draw is ever wasted on one that can't. Sensors are
+    //picked using the passed generator.
+    void randomAssign(Mission & task, const int  num_sensors, RandGen & rng)
+    {
+      RandomPolicy policy(rng);
+      schedule(task, num_sensors, policy);
+      return;      
+    }
+
+    //MISSION ASSIGNMENT FUNCTION
+    //Description: This function is used to assign a mission to a Network.
+    //It first marks the mission as attempted, and then if there are enough
+    //sensors available to complete the mission, then the sensors with the
+    //most energy are assigned to the mission until the amount of sensors
+    //needed is reached. The network then records it as a satisfied
+    //mission. If used is given, the index of every sensor that was
+    //assigned is appended to it.
+    void missionAssign(Mission & task, const int  num_sensors,
+                       vector<int>* used = NULL)
+    {
+      MostEnergyPolicy policy(used);
+      schedule(task, num_sensors, policy);
+      return;      
+    }
+
+    //POLICY SCHEDULING FUNCTION
+    //Description: Attempts a mission with the passed scheduling policy.
+    //Every sensor that could be assigned to the mission is a candidate.
+    //If there are at least as many
+    //candidates as the mission demands (num_sensors, unless it sets its
+    //own) and the policy's ranking accepts them, that many are assigned
+    //from the front of the ranking and the mission is satisfied.
+    template <class Policy>
+    void schedule(Mission & task, const int num_sensors, Policy & policy)
+    {
+      task.attempted = true; //The mission is marked as attempted
+      const int need = task.demand(num_sensors); //Sensors the mission needs
+      gatherInRange(task, task.getEND() - task.getSTART(), m_work);
+      vector<int> & chosen = m_work.chosen;
+      chosen.clear();
+      for (size_t j = 0; j < m_work.cand.size(); j++)
+      {
+        int i = m_work.cand[j];
+        if (accepts(i, task))
+        {
+          chosen.push_back(i);
+        }
+      }
+      if (static_cast<int>(chosen.size()) >= need &&
+          policy.rank(chosen, need, task, m_store))
+      {
+        for (int k = 0; k < need; k++) //Assigns the ranked sensors
+        {
+          assign(chosen[k], task);
+        }
+        policy.commit(chosen.data(), need, task);
+        m_mission_satis++; //Increments amount of missions satisfied
+      }
+      m_mission_count++; //Another mission attempt is recorded
+      recordHealth();
+      return;
+    }
+
+    //TOTAL ENERGY CALCULATION FUNCTION
+    //Description: Used in the Offline Algorithm. Let us define the "TE", or
+    //Total Energy, of a mission as the sum of all remaining energy on all
+    //sensors that the mission would use if it were accepted. So, this function
+    //takes a mission and the amount of sensors needed as parameters, and then
+    //sums up all the energy amongst the sensors that would be assigned were
+    //that mission to be satisfied.
+    int calcTE(Mission & task, const int num_sensors)
+    {
+      return calcTE(task, num_sensors, m_work);
+    }
+
+    //TOTAL ENERGY CALCULATION FUNCTION
+    //Description: Same as calcTE, but works in the passed buffers and
+    //leaves the Network untouched, so several threads may evaluate
+    //missions at once while nothing is being assigned. A mission that sets
+    //its own demand is costed with that many sensors.
+    int calcTE(const Mission & task, const int num_sensors,
+               SelectScratch & w)const
+    {
+      SNMS_COUNT(C_CALC_TE, 1);
+      const int need = task.demand(num_sensors); //Sensors the mission needs
+      if (selectCandidates(task, need, w) < need)
+      { //If there aren't enough sensors available for scheduling, TE must
+        return 0; //be zero.
+      }
+      int TE = 0; //Total energy of across all sensors that would be used for a
+      //mission.
+      for (int p = 0; p < need; p++)
+      {
+        TE += m_store.st_energy[w.chosen[p]];
+        //Adds total energy of chosen sensor to total
+      }
+      return TE;
+    }      
+};  
+
+//BUILD FUNCTION (ELIGIBILITY GRAPH)
+//Description: Defined here since it needs the complete Network. The
+//forward rows come from one range query per mission, with any attached
+//graph detached so the query really runs. The reverse rows are then
+//filled by a counting sort, which leaves each of them in mission order.
+void EligibilityGraph::build(Network & net, vector<Mission> & list)
+{
+  int m_total = static_cast<int>(list.size()); //Number of missions
+  int s_total = net.getNUM(); //Number of sensors
+  net.attachGraph(NULL);
+  g_row_start.assign(1, 0);
+  g_row_start.reserve(m_total + 1);
+  g_sensor.clear();
+  g_col_start.assign(s_total + 1, 0);
+  for (int i = 0; i < m_total; i++)
+  {
+    list[i].setINDEX(i);
+    const vector<int> & in_range = net.sensorsInRange(list[i]);
+    g_sensor.insert(g_sensor.end(), in_range.begin(), in_range.end());
+    g_row_start.push_back(static_cast<int>(g_sensor.size()));
+    for (size_t j = 0; j < in_range.size(); j++)
+    {
+      g_col_start[in_range[j] + 1]++;
+    }
+  }
+  for (int s = 0; s < s_total; s++) //Converts counts into offsets
+  {
+    g_col_start[s + 1] += g_col_start[s];
+  }
+  g_mission.resize(g_sensor.size());
+  vector<int> fill(g_col_start.begin(), g_col_start.end() - 1);
+  for (int i = 0; i < m_total; i++)
+  {
+    for (int j = g_row_start[i]; j < g_row_start[i + 1]; j++)
+    {
+      g_mission[fill[g_sensor[j]]++] = i;
+    }
+  }
+  return;
+}
+
+////////////////////////
+///OFFLINE_CHECKPOINT///
+////////////////////////
+
+//A long offline pass can be checkpointed. The pass calls tick after every
+//mission it attempts, and once every c_every seconds a snapshot is
+//written: a CheckpointHeader, the caller's own header, the Network's
+//state and a bitmap of the missions attempted, in the host's byte order.
+//Each snapshot goes to a temporary file that is then renamed over the
+//last one, so a crash always leaves one complete snapshot behind. The
+//offline passes choose their next mission from the current state alone,
+//so a pass started on a restored snapshot goes on exactly as the pass
+//that wrote it would have. No generator is drawn from during the pass.
+
+const char CHECKPOINT_MAGIC[4] = {'S', 'N', 'M', 'C'};
+const uint32_t CHECKPOINT_VERSION = 2;
+
+struct CheckpointHeader
+{
+  char magic[4]; //Always CHECKPOINT_MAGIC
+  uint32_t version; //Layout version, CHECKPOINT_VERSION
+  uint32_t header_bytes; //Size of the caller's header
+  uint32_t mission_count; //Missions in the bitmap, or 0 if no state follows
+};
+
+class OfflineCheckpoint
+{
+  private:
+    string c_path; //File the snapshots are written to
+    double c_every; //Seconds between snapshots
+    chrono::steady_clock::time_point c_due; //When the next one is due
+    string c_header; //Caller's bytes, written ahead of the state
+    double c_cost; //Seconds spent writing snapshots
+    int c_count; //Snapshots written
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    OfflineCheckpoint(){ c_every = 0; c_cost = 0; c_count = 0; }
+
+    //START FUNCTION
+    //Description: Sends snapshots to path, the first one every seconds
+    //from now, each led by the passed header.
+    void start(const string & path, const double every, const string & header)
+    {
+      c_path = path;
+      c_every = every;
+      c_header = header;
+      c_cost = 0;
+      c_count = 0;
+      c_due = chrono::steady_clock::now() +
+              chrono::duration_cast<chrono::steady_clock::duration>(
+                chrono::duration<double>(every));
+      return;
+    }
+
+    //TICK FUNCTION
+    //Description: Writes a snapshot if one is due.
+    void tick(const Network & net, const vector<Mission> & list)
+    {
+      if (chrono::steady_clock::now() >= c_due)
+      {
+        save(&net, &list);
+      }
+      return;
+    }
+
+    //SAVE FUNCTION
+    //Description: Writes a snapshot now. If net is NULL only the header
+    //is written. Returns false if the file couldn't be written.
+    bool save(const Network* net, const vector<Mission>* list)
+    {
+      chrono::steady_clock::time_point begin = chrono::steady_clock::now();
+      CheckpointHeader head;
+      memcpy(head.magic, CHECKPOINT_MAGIC, 4);
+      head.version = CHECKPOINT_VERSION;
+      head.header_bytes = static_cast<uint32_t>(c_header.size());
+      head.mission_count = (net != NULL) ?
+                           static_cast<uint32_t>(list->size()) : 0;
+      string temp = c_path + ".tmp";
+      ofstream out(temp.c_str(), ios::binary);
+      out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+      out.write(c_header.data(), c_header.size());
+      if (net != NULL)
+      {
+        net->writeState(out);
+        vector<uint64_t> bits((list->size() + 63)/64, 0); //Attempted flags
+        for (size_t m = 0; m < list->size(); m++)
+        {
+          if ((*list)[m].attempted)
+          {
+            bits[m >> 6] |= uint64_t(1) << (m & 63);
+          }
+        }
+        out.write(reinterpret_cast<const char*>(bits.data()),
+                  bits.size()*sizeof(uint64_t));
+      }
+      out.close();
+      bool written = out && rename(temp.c_str(), c_path.c_str()) == 0;
+      if (!written)
+      {
+        cerr << "Could not write checkpoint " << c_path << endl;
+      }
+      chrono::steady_clock::time_point end = chrono::steady_clock::now();
+      c_cost += chrono::duration<double>(end - begin).count();
+      c_count++;
+      c_due = end + chrono::duration_cast<chrono::steady_clock::duration>(
+                      chrono::duration<double>(c_every));
+      return written;
+    }
+
+    //LOAD FUNCTION
+    //Description: Reads the snapshot at path, putting the caller's header
+    //in header. If net is given, the Network's state and the attempted
+    //flags of list are restored as well. Returns false if the file is
+    //missing or damaged, or if state was asked for but doesn't match.
+    static bool load(const string & path, string & header, Network* net,
+                     vector<Mission>* list)
+    {
+      ifstream in(path.c_str(), ios::binary);
+      CheckpointHeader head;
+      if (!in.read(reinterpret_cast<char*>(&head), sizeof(head)) ||
+          memcmp(head.magic, CHECKPOINT_MAGIC, 4) != 0 ||
+          head.version != CHECKPOINT_VERSION || head.header_bytes > 1 << 20)
+      {
+        return false;
+      }
+      header.resize(head.header_bytes);
+      if (!in.read(&header[0], header.size()))
+      {
+        return false;
+      }
+      if (net == NULL)
+      {
+        return true;
+      }
+      if (head.mission_count != list->size() || !net->readState(in))
+      {
+        return false;
+      }
+      vector<uint64_t> bits((list->size() + 63)/64);
+      if (!in.read(reinterpret_cast<char*>(bits.data()),
+                   bits.size()*sizeof(uint64_t)))
+      {
+        return false;
+      }
+      for (size_t m = 0; m < list->size(); m++)
+      {
+        (*list)[m].attempted = (bits[m >> 6] >> (m & 63)) & 1;
+      }
+      return true;
+    }
+
+    //ACCESSOR FUNCTIONS
+    double getCOST()const{ return c_cost; }
+    int getCOUNT()const{ return c_count; }
+
+    //MUTATOR FUNCTIONS
+    void setHEADER(const string & header){ c_header = header; }
+
+};
+
+///////////////////////
+///OFFLINE_SCHEDULER///
+///////////////////////
+
+//This object runs the Offline Algorithm. Rather than recomputing the TE of
+//every mission each time one is chosen, it keeps the missions in a max-heap
+//keyed by (TE, index). A mission's TE only depends on the sensors in its
+//range, and it can only shrink as those sensors lose energy and gain
+//schedules. So when a mission is assigned, only the missions sharing one
+//of its sensors are flagged, and a flagged mission has its TE recomputed
+//when it reaches the top of the heap. A heap entry that is current when it
+//reaches the top is the mission the full scan would have chosen, including
+//the scan's preference for the last index among equal TEs.
+
+class OfflineScheduler
+{
+  private:
+    EligibilityGraph o_graph; //Used when the caller doesn't supply a graph
+    vector<int> o_te; //Latest computed TE of each mission
+    vector<char> o_dirty; //Marks missions whose TE may have gone down
+    priority_queue<pair<int, int> > o_heap; //Entries of (TE, index)
+
+  public:
+
+    //RUN FUNCTION
+    //Description: Attempts every mission in the list on the passed Network,
+    //always choosing the unattempted mission with the greatest TE next.
+    //Produces the same assignments as recomputing every TE each time.
+    //The graph's reverse map is used to find the missions affected by an
+    //assignment. If no graph is passed, one is built for the list.
+    //Missions already attempted, as after a restored snapshot, are
+    //skipped. Returns the index of the last mission attempted.
+    int run(Network & net, vector<Mission> & list, const int num_sensors,
+            const EligibilityGraph* graph = NULL,
+            OfflineCheckpoint* checkpoint = NULL)
+    {
+      int m_total = static_cast<int>(list.size()); //Number of missions
+      if (graph == NULL)
+      {
+        o_graph.build(net, list);
+        graph = &o_graph;
+      }
+      o_te.assign(m_total, 0);
+      o_dirty.assign(m_total, 0);
+      o_heap = priority_queue<pair<int, int> >();
+      int offcount = 0; //Used to count missions attempted
+      for (int i = 0; i < m_total; i++) //Computes every starting TE
+      {
+        if (list[i].attempted)
+        {
+          offcount++;
+          continue;
+        }
+        o_te[i] = net.calcTE(list[i], num_sensors);
+        o_heap.push(make_pair(o_te[i], i));
+      }
+
+      vector<int> used; //Sensors assigned to the chosen mission
+      int index = 0; //Index of the mission being attempted
+      while (offcount < m_total)
+      {
+        pair<int, int> top = o_heap.top();
+        o_heap.pop();
+        index = top.second;
+        if (list[index].attempted || top.first != o_te[index])
+        { //The mission was already chosen, or this entry is out of date
+          continue;
+        }
+        if (o_dirty[index]) //Recomputes the TE and puts the mission back
+        {
+          o_dirty[index] = 0;
+          SNMS_COUNT(C_TE_REEVAL, 1);
+          o_te[index] = net.calcTE(list[index], num_sensors);
+          o_heap.push(make_pair(o_te[index], index));
+          continue;
+        }
+        used.clear();
+        net.missionAssign(list[index], num_sensors, &used);
+        for (size_t j = 0; j < used.size(); j++) //Flags affected missions
+        {
+          const int* touched = graph->missionsOf(used[j]);
+          int num_touched = graph->missionCount(used[j]);
+          for (int t = 0; t < num_touched; t++)
+          {
+            o_dirty[touched[t]] = 1;
+          }
+        }
+        offcount++; //Additional mission attempt recorded
+        if (checkpoint != NULL)
+        {
+          checkpoint->tick(net, list);
+        }
+      }
+      return index;
+    }
+};
+
+/////////////////////
+///POLICY_REGISTRY///
+/////////////////////
+
+//These are the policies --policy can name. Each entry runs a whole pass
+//over a trial's missions, so the choice of policy is made once per trial
+//and never inside the per-sensor loop. To add a policy, define it in
+//SCHEDULING_POLICIES and list it here.
+
+//Every pass gets the same arguments, whether or not it uses them.
+typedef void (*PolicyPass)(Network & net, vector<Mission> & list,
+                           const int num_sensors, RandGen & rng,
+                           const EligibilityGraph* graph);
+
+struct PolicyEntry
+{
+  const char* name; //Name given to --policy
+  const char* about; //One line description
+  PolicyPass run; //Attempts every mission of a list
+};
+
+//POLICY CONSTRUCTION FUNCTION
+//Description: Builds a policy for a pass. Only policies with state need
+//a specialization.
+template <class Policy>
+Policy makePolicy(RandGen & /*rng*/)
+{
+  return Policy();
+}
+
+template <>
+RandomPolicy makePolicy<RandomPolicy>(RandGen & rng)
+{
+  return RandomPolicy(rng);
+}
+
+//ARRIVAL PASS FUNCTION
+//Description: Attempts every mission in order of start time with one
+//policy, as the Random and Online Algorithms do.
+template <class Policy>
+void arrivalPass(Network & net, vector<Mission> & list, const int num_sensors,
+                 RandGen & rng, const EligibilityGraph* /*graph*/)
+{
+  Policy policy = makePolicy<Policy>(rng);
+  for (size_t i = 0; i < list.size(); i++)
+  {
+    net.schedule(list[i], num_sensors, policy);
+  }
+  return;
+}
+
+//OFFLINE PASS FUNCTION
+//Description: Runs the Offline Algorithm, which orders the missions
+//itself and picks sensors with the Online Algorithm's policy.
+void offlinePass(Network & net, vector<Mission> & list, const int num_sensors,
+                 RandGen & /*rng*/, const EligibilityGraph* graph)
+{
+  OfflineScheduler offline;
+  offline.run(net, list, num_sensors, graph);
+  return;
+}
+
+const PolicyEntry POLICY_REGISTRY[] =
+{
+  {"random", "random sensors, missions in order of start time",
+   arrivalPass<RandomPolicy>},
+  {"online", "sensors with the most energy, missions in order of start time",
+   arrivalPass<MostEnergyPolicy>},
+  {"offline", "sensors with the most energy, missions by greatest TE",
+   offlinePass},
+  {"best-fit", "sensors with the least energy that can cover the mission",
+   arrivalPass<LeastEnergyPolicy>},
+  {"nearest", "sensors closest to the mission's epicenter",
+   arrivalPass<NearestPolicy>}
+};
+const int NUM_POLICIES = sizeof(POLICY_REGISTRY)/sizeof(POLICY_REGISTRY[0]);
+
+//POLICY LOOKUP FUNCTION
+//Description: Returns the registered policy with the passed name, or NULL.
+const PolicyEntry* findPolicy(const string & name)
+{
+  for (int p = 0; p < NUM_POLICIES; p++)
+  {
+    if (name == POLICY_REGISTRY[p].name)
+    {
+      return &POLICY_REGISTRY[p];
+    }
+  }
+  return NULL;
+}
+
+/////////////////////////////////
+///PARALLEL_OFFLINE_SCHEDULER///
+/////////////////////////////////
+
+//This object runs the Offline Algorithm the original way, finding the
+//greatest TE among every unattempted mission before each attempt, but
+//splits that search across a pool of threads. The unattempted missions
+//are kept in index order and cut into one contiguous chunk per thread.
+//Each thread finds the last mission of its chunk with the greatest TE,
+//and the chunks are then combined in order, a later chunk winning ties.
+//That is the same mission the serial loop's ">=" picks, so the
+//assignments match it exactly, whatever the number of threads. The
+//threads only read the Network while they search, and wait at a barrier
+//while the chosen mission is assigned.
+
+class ParallelOfflineScheduler
+{
+  private:
+    int p_threads; //Number of threads searching, the caller's included
+    vector<SelectScratch> p_scratch; //Buffers of each thread
+    vector<pair<int, int> > p_best; //(TE, index) found by each thread
+    vector<int> p_left; //Unattempted missions, in index order
+    Network* p_net; //Network being scheduled
+    vector<Mission>* p_list; //Missions being scheduled
+    int p_req; //Sensors required per mission
+    bool p_done; //Set once every mission has been attempted
+    mutex p_lock; //Guards the barrier
+    condition_variable p_wake; //Wakes the threads waiting at the barrier
+    int p_waiting; //Threads waiting at the barrier
+    long long p_generation; //Number of times the barrier has opened
+
+    //BARRIER FUNCTION
+    //Description: Waits until every thread has arrived.
+    void barrier()
+    {
+      unique_lock<mutex> hold(p_lock);
+      long long gen = p_generation;
+      if (++p_waiting == p_threads)
+      {
+        p_waiting = 0;
+        p_generation++;
+        p_wake.notify_all();
+      }
+      else
+      {
+        while (p_generation == gen)
+        {
+          p_wake.wait(hold);
+        }
+      }
+      return;
+    }
+
+    //SCAN FUNCTION
+    //Description: Finds the last mission in chunk t of p_left with the
+    //greatest TE. The index is -1 if the chunk is empty.
+    void scan(const int t)
+    {
+      size_t n = p_left.size();
+      size_t first = n*t/p_threads;
+      size_t last = n*(t + 1)/p_threads;
+      int best_te = -1;
+      int best = -1;
+      for (size_t j = first; j < last; j++)
+      {
+        int i = p_left[j];
+        int te = p_net->calcTE((*p_list)[i], p_req, p_scratch[t]);
+        if (te >= best_te)
+        {
+          best_te = te;
+          best = i;
+        }
+      }
+      p_best[t] = make_pair(best_te, best);
+      return;
+    }
+
+    //WORKER FUNCTION
+    //Description: Searches chunk t at every step until the run is done.
+    void work(const int t)
+    {
+      while (true)
+      {
+        barrier(); //Waits for a step to begin
+        if (p_done)
+        {
+          break;
+        }
+        scan(t);
+        barrier(); //Reports the chunk's result
+      }
+      SNMS_FLUSH();
+      return;
+    }
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    ParallelOfflineScheduler()
+    {
+      p_threads = 1;
+      p_net = NULL;
+      p_list = NULL;
+      p_req = 0;
+      p_done = false;
+      p_waiting = 0;
+      p_generation = 0;
+    }
+
+    //RUN FUNCTION
+    //Description: Attempts every mission in the list on the passed Network,
+    //always choosing the unattempted mission with the greatest TE next,
+    //using num_threads threads to search. Missions already attempted are
+    //skipped. Returns the index of the last mission attempted.
+    int run(Network & net, vector<Mission> & list, const int num_sensors,
+            const int num_threads, OfflineCheckpoint* checkpoint = NULL)
+    {
+      p_threads = max(1, num_threads);
+      p_scratch.resize(p_threads);
+      p_best.assign(p_threads, make_pair(-1, -1));
+      p_net = &net;
+      p_list = &list;
+      p_req = num_sensors;
+      p_done = false;
+      p_waiting = 0;
+      p_left.clear();
+      for (int i = 0; i < static_cast<int>(list.size()); i++)
+      {
+        if (!list[i].attempted)
+        {
+          p_left.push_back(i);
+        }
+      }
+      vector<thread> pool;
+      for (int t = 1; t < p_threads; t++)
+      {
+        pool.push_back(thread(&ParallelOfflineScheduler::work, this, t));
+      }
+
+      int index = 0; //Index of the mission being attempted
+      while (!p_left.empty())
+      {
+        barrier(); //Starts the step
+        scan(0);
+        barrier(); //Waits for every chunk
+        pair<int, int> best(-1, -1); //Greatest TE, last index on ties
+        for (int t = 0; t < p_threads; t++)
+        {
+          if (p_best[t].second >= 0 && p_best[t].first >= best.first)
+          {
+            best = p_best[t];
+          }
+        }
+        index = best.second;
+        net.missionAssign(list[index], num_sensors); //Attempts mission
+        p_left.erase(lower_bound(p_left.begin(), p_left.end(), index));
+        if (checkpoint != NULL)
+        {
+          checkpoint->tick(net, list);
+        }
+      }
+      p_done = true;
+      barrier(); //Releases the threads
+      for (size_t t = 0; t < pool.size(); t++)
+      {
+        pool[t].join();
+      }
+      return index;
+    }
+
+};
+
+////////////////
+///FLOW_GRAPH///
+////////////////
+
+//This object finds a maximum flow by Dinic's algorithm. Edges are stored
+//in pairs, so edge e^1 is the reverse of edge e, and its capacity is the
+//flow sent along e.
+
+class FlowGraph
+{
+  private:
+    vector<int> f_head; //First edge leaving each node, or -1
+    vector<int> f_next; //Next edge leaving the same node, or -1
+    vector<int> f_to; //Node each edge enters
+    vector<int> f_cap; //Capacity left on each edge
+    vector<int> f_level; //Distance of each node from the source
+    vector<int> f_iter; //Next edge of each node to try
+    vector<int> f_queue; //Queue of the breadth first search
+
+    //LEVEL FUNCTION
+    //Description: Labels each node with its distance from s over edges
+    //with capacity left. Returns true if t can be reached.
+    bool levels(const int s, const int t)
+    {
+      fill(f_level.begin(), f_level.end(), -1);
+      f_queue.clear();
+      f_queue.push_back(s);
+      f_level[s] = 0;
+      for (size_t q = 0; q < f_queue.size(); q++)
+      {
+        int v = f_queue[q];
+        for (int e = f_head[v]; e >= 0; e = f_next[e])
+        {
+          if (f_cap[e] > 0 && f_level[f_to[e]] < 0)
+          {
+            f_level[f_to[e]] = f_level[v] + 1;
+            f_queue.push_back(f_to[e]);
+          }
+        }
+      }
+      return f_level[t] >= 0;
+    }
+
+    //AUGMENT FUNCTION
+    //Description: Pushes up to limit units of flow from v to t along
+    //edges that go one level deeper each step. Returns the flow pushed.
+    int augment(const int v, const int t, const int limit)
+    {
+      if (v == t)
+      {
+        return limit;
+      }
+      for (int & e = f_iter[v]; e >= 0; e = f_next[e])
+      {
+        int u = f_to[e];
+        if (f_cap[e] > 0 && f_level[u] == f_level[v] + 1)
+        {
+          int pushed = augment(u, t, min(limit, f_cap[e]));
+          if (pushed > 0)
+          {
+            f_cap[e] -= pushed;
+            f_cap[e ^ 1] += pushed;
+            return pushed;
+          }
+        }
+      }
+      return 0;
+    }
+
+  public:
+
+    //RESET FUNCTION
+    //Description: Removes every edge, leaving num_nodes nodes.
+    void reset(const int num_nodes)
+    {
+      f_head.assign(num_nodes, -1);
+      f_level.resize(num_nodes);
+      f_iter.resize(num_nodes);
+      f_next.clear();
+      f_to.clear();
+      f_cap.clear();
+    }
+
+    //EDGE FUNCTION
+    //Description: Adds an edge from a to b and returns its number.
+    int addEdge(const int a, const int b, const int cap)
+    {
+      int e = static_cast<int>(f_to.size());
+      f_to.push_back(b);
+      f_cap.push_back(cap);
+      f_next.push_back(f_head[a]);
+      f_head[a] = e;
+      f_to.push_back(a);
+      f_cap.push_back(0);
+      f_next.push_back(f_head[b]);
+      f_head[b] = e + 1;
+      return e;
+    }
+
+    //MAXIMUM FLOW FUNCTION
+    //Description: Sends as much flow as possible from s to t and returns
+    //the amount. Flow already sent is kept, so after edges change only
+    //the flow added is returned.
+    int maxFlow(const int s, const int t)
+    {
+      int total = 0;
+      while (levels(s, t))
+      {
+        f_iter = f_head;
+        int pushed;
+        while ((pushed = augment(s, t, INT_MAX)) > 0)
+        {
+          total += pushed;
+        }
+      }
+      return total;
+    }
+
+    //FLOW FUNCTION
+    //Description: Returns the flow sent along edge e.
+    int flowOn(const int e)const{ return f_cap[e ^ 1]; }
+
+    //CANCEL FUNCTION
+    //Description: Removes the flow sent along edge e, giving the edge its
+    //full capacity back. The caller keeps the flow balanced at both ends.
+    void cancel(const int e){ f_cap[e] += f_cap[e ^ 1]; f_cap[e ^ 1] = 0; }
+
+    //CLOSE FUNCTION
+    //Description: Removes the flow and the capacity of edge e.
+    void close(const int e){ f_cap[e] = 0; f_cap[e ^ 1] = 0; }
+
+};
+
+/////////////////////
+///BATCH_SCHEDULER///
+/////////////////////
+
+//This object runs the Batch Algorithm. Missions are gathered into windows
+//of window time units by start time, and each window is split into
+//groups of missions whose times overlap, chained through each other.
+//Missions in different groups never overlap, so the groups are scheduled
+//one after another, each as a flow problem: the source feeds each
+//mission its demand, each mission links to every sensor that could be
+//assigned to it, and each sensor passes at most one unit to the sink, so
+//it serves at most one mission per group. A mission only counts if it
+//gets every sensor it needs, so while the flow leaves some mission short,
+//the shortest one (the latest on ties) is dropped, its flow is removed,
+//and the remaining flow is augmented again. Sensors are listed most
+//energy first, which steers the flow toward them. Wider windows let more
+//missions share the search, at the cost of a longer wait before each
+//mission is scheduled.
+
+class BatchScheduler
+{
+  private:
+    FlowGraph b_flow; //Flow problem of the current group
+    vector<vector<int> > b_elig; //Sensors that could serve each mission
+    vector<char> b_active; //Marks missions still being scheduled
+    vector<int> b_edge; //Source edge of each active mission
+    vector<int> b_node; //Node of each sensor in the group, or -1
+    vector<int> b_sensor; //Sensor of each sensor node
+    vector<int> b_sink; //Sink edge of each sensor node
+    vector<int> b_picked; //Sensors assigned to one mission
+
+    //BUILD FUNCTION
+    //Description: Builds the flow problem for the active missions of a
+    //group, the count missions starting at group. Returns the flow that
+    //fills every one of them.
+    int build(const Mission* group, const int count, const int num_sensors)
+    {
+      b_sensor.clear();
+      for (int j = 0; j < count; j++)
+      {
+        if (b_active[j])
+        {
+          for (size_t q = 0; q < b_elig[j].size(); q++)
+          {
+            if (b_node[b_elig[j][q]] < 0)
+            {
+              b_node[b_elig[j][q]] = static_cast<int>(b_sensor.size());
+              b_sensor.push_back(b_elig[j][q]);
+            }
+          }
+        }
+      }
+      int sensor_nodes = static_cast<int>(b_sensor.size());
+      const int source = 0, sink = 1, first_sensor = 2 + count;
+      b_flow.reset(first_sensor + sensor_nodes);
+      int wanted = 0; //Flow that fills every active mission
+      for (int j = 0; j < count; j++)
+      {
+        b_edge[j] = -1;
+        if (b_active[j])
+        {
+          int need = group[j].demand(num_sensors); //Units the mission needs
+          b_edge[j] = b_flow.addEdge(source, 2 + j, need);
+          wanted += need;
+          for (int q = static_cast<int>(b_elig[j].size()) - 1; q >= 0; q--)
+          { //Added in reverse, since edges are tried newest first
+            b_flow.addEdge(2 + j, first_sensor + b_node[b_elig[j][q]], 1);
+          }
+        }
+      }
+      b_sink.resize(sensor_nodes);
+      for (int v = 0; v < sensor_nodes; v++)
+      {
+        b_sink[v] = b_flow.addEdge(first_sensor + v, sink, 1);
+      }
+      return wanted;
+    }
+
+    //DROP FUNCTION
+    //Description: Removes active mission j and the flow sent through it,
+    //freeing its sensors for the others. Returns the flow removed.
+    int drop(const int j)
+    {
+      int removed = b_flow.flowOn(b_edge[j]); //Flow the mission held
+      int size = static_cast<int>(b_elig[j].size());
+      for (int q = 0; q < size; q++)
+      {
+        int e = b_edge[j] + 2*(size - q); //Edge to the q-th sensor
+        if (b_flow.flowOn(e) > 0)
+        {
+          b_flow.cancel(b_sink[b_node[b_elig[j][q]]]);
+        }
+        b_flow.close(e);
+      }
+      b_flow.close(b_edge[j]);
+      b_active[j] = 0;
+      return removed;
+    }
+
+    //GROUP FUNCTION
+    //Description: Schedules the count missions starting at group, which
+    //overlap no mission outside the group.
+    void schedule(Network & net, Mission* group, const int count,
+                  const int num_sensors, const MoreEnergy & order)
+    {
+      b_elig.resize(count);
+      b_active.assign(count, 1);
+      b_edge.resize(count);
+      for (int j = 0; j < count; j++)
+      {
+        b_elig[j] = net.eligibleSensors(group[j]);
+        sort(b_elig[j].begin(), b_elig[j].end(), order);
+        b_active[j] = static_cast<int>(b_elig[j].size()) >=
+                      group[j].demand(num_sensors);
+      }
+      const int source = 0, sink = 1;
+      int wanted = build(group, count, num_sensors);
+      int sent = b_flow.maxFlow(source, sink); //Flow reaching the sink
+      while (sent < wanted)
+      {
+        int shortest = -1; //Active mission with the least flow
+        for (int j = 0; j < count; j++)
+        {
+          if (b_active[j] && (shortest < 0 || b_flow.flowOn(b_edge[j]) <=
+                              b_flow.flowOn(b_edge[shortest])))
+          {
+            shortest = j;
+          }
+        }
+        wanted -= group[shortest].demand(num_sensors);
+        sent -= drop(shortest);
+        sent += b_flow.maxFlow(source, sink);
+      }
+      for (size_t v = 0; v < b_sensor.size(); v++)
+      {
+        b_node[b_sensor[v]] = -1;
+      }
+      for (int j = 0; j < count; j++) //Assigns the flow's sensors
+      {
+        b_picked.clear();
+        if (b_active[j])
+        {
+          for (size_t q = 0; q < b_elig[j].size(); q++)
+          {
+            if (b_flow.flowOn(b_edge[j] + 2*(b_elig[j].size() - q)) > 0)
+            {
+              b_picked.push_back(b_elig[j][q]);
+            }
+          }
+        }
+        net.assignSensors(group[j], num_sensors, b_picked.data(),
+                          static_cast<int>(b_picked.size()));
+      }
+      return;
+    }
+
+  public:
+
+    //RUN FUNCTION
+    //Description: Attempts every mission in the list, in windows of
+    //window time units.
+    void run(Network & net, vector<Mission> & list, const int num_sensors,
+             const int window)
+    {
+      int m_total = static_cast<int>(list.size());
+      b_node.assign(net.getNUM(), -1);
+      MoreEnergy order; //Most energy first, then lowest index
+      order.energy = net.getENERGIES();
+      int first = 0; //First mission of the window
+      while (first < m_total)
+      {
+        int last = first; //One past the last mission of the window
+        while (last < m_total &&
+               list[last].getSTART() - list[first].getSTART() < window)
+        {
+          last++;
+        }
+        int start = first; //First mission of the group
+        while (start < last)
+        {
+          int stop = start + 1; //One past the last mission of the group
+          int reach = list[start].getEND(); //Latest end in the group
+          while (stop < last && list[stop].getSTART() < reach)
+          {
+            reach = max(reach, list[stop].getEND());
+            stop++;
+          }
+          schedule(net, &list[start], stop - start, num_sensors, order);
+          start = stop;
+        }
+        first = last;
+      }
+      return;
+    }
+
+};
+
+//////////////////////////
+///SWEEP_LINE_SCHEDULER///
+//////////////////////////
+
+//This object runs the Online Algorithm as an event driven sweep over
+//time. Missions must arrive in order of start time. Every assignment
+//queues a release event at the mission's end time, and a bitset marks the
+//sensors that are busy. Before a mission is handled, every event at or
+//before its start is released. Since no earlier mission starts later than
+//the current one, a sensor's schedule overlaps the mission exactly when
+//the sensor is still busy, so the whole time_plan check becomes one bit
+//test. The engine keeps its own copy of the sensors' energy and never
+//stores schedules, so its memory does not grow with the number of
+//missions. It picks the same sensors as Network::missionAssign.
+
+class SweepLineScheduler
+{
+  private:
+    Network* e_net; //Network supplying sensor positions and range queries
+    vector<int> e_energy; //Energy level of each sensor
+    vector<uint64_t> e_busy; //Bit s is set while sensor s is on a mission
+    priority_queue<pair<int, int>, vector<pair<int, int> >,
+                   greater<pair<int, int> > > e_release; //(end, sensor)
+    vector<int> e_cand; //Sensors that can be assigned to the mission
+    EnergyIndex e_levels; //Number of sensors at each energy level
+    vector<HealthPoint>* e_health; //Health after each mission, if tracked
+    int e_health_dura; //Energy below which a sensor counts as low energy
+    int e_now; //Start time of the latest mission handled
+    int e_mission_count; //Number of missions processed
+    int e_mission_satis; //Number of missions satisfied
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    SweepLineScheduler()
+    {
+      e_net = NULL;
+      e_health = NULL;
+      e_health_dura = 0;
+      e_now = INT_MIN;
+      e_mission_count = 0;
+      e_mission_satis = 0;
+    }
+
+    //RESET FUNCTION
+    //Description: Starts a new sweep over the passed Network's sensors,
+    //using their current energy levels. No sensor starts out busy.
+    void reset(Network & net)
+    {
+      e_net = &net;
+      int num = net.getNUM(); //Number of sensors
+      e_energy.resize(num);
+      e_levels.clear();
+      for (int i = 0; i < num; i++)
+      {
+        e_energy[i] = net.getSENSOR(i).getENERGY();
+        e_levels.insert(e_energy[i]);
+      }
+      e_busy.assign((num + 63)/64, 0);
+      e_release = priority_queue<pair<int, int>, vector<pair<int, int> >,
+                                 greater<pair<int, int> > >();
+      e_now = INT_MIN;
+      e_mission_count = 0;
+      e_mission_satis = 0;
+      return;
+    }
+
+    //ASSIGNMENT FUNCTION
+    //Description: Advances the sweep to the mission's start, then assigns
+    //the sensors it demands with the most energy that are in range, not
+    //busy and have enough energy, if there are that many. Returns true if
+    //the mission was satisfied. A mission starting before the previous one
+    //is not handled, and counts as unsatisfied.
+    bool process(Mission & task, const int num_sensors)
+    {
+      bool satisfied = assign(task, num_sensors);
+      if (e_health != NULL)
+      {
+        HealthPoint point;
+        point.low_energy = e_levels.countBelow(e_health_dura);
+        point.median_energy = e_levels.percentile(0.5);
+        e_health->push_back(point);
+      }
+      return satisfied;
+    }
+
+    //HEALTH TRACKING FUNCTION
+    //Description: While curve isn't NULL, the health of the sensors after
+    //every mission processed is appended to curve.
+    void trackHealth(const int dura, vector<HealthPoint>* curve)
+    {
+      e_health_dura = dura;
+      e_health = curve;
+      return;
+    }
+
+  private:
+
+    //SWEEP ASSIGNMENT FUNCTION
+    //Description: Does the work of process, apart from tracking health.
+    bool assign(Mission & task, const int num_sensors)
+    {
+      int sta = task.getSTART();
+      int e_cost = task.getEND() - sta; //Energy cost of the mission
+      const int need = task.demand(num_sensors); //Sensors the mission needs
+      task.attempted = true;
+      e_mission_count++;
+      if (sta < e_now)
+      {
+        return false;
+      }
+      e_now = sta;
+      while (!e_release.empty() && e_release.top().first <= sta)
+      { //Frees every sensor whose mission has ended
+        int s = e_release.top().second;
+        e_busy[s >> 6] &= ~(uint64_t(1) << (s & 63));
+        e_release.pop();
+      }
+      const vector<int> & in_range = e_net->sensorsInRange(task);
+      e_cand.clear();
+      for (size_t j = 0; j < in_range.size(); j++)
+      {
+        int s = in_range[j];
+        bool busy = (e_busy[s >> 6] >> (s & 63)) & 1;
+        if (!busy && e_energy[s] >= e_cost)
+        {
+          e_cand.push_back(s);
+        }
+      }
+      int eligible = static_cast<int>(e_cand.size());
+      if (eligible < need)
+      {
+        return false;
+      }
+      MoreEnergy order; //Same pick order as missionAssign
+      order.energy = e_energy.data();
+      if (need > 0 && eligible > need)
+      {
+        nth_element(e_cand.begin(), e_cand.begin() + (need - 1),
+                    e_cand.end(), order);
+      }
+      for (int k = 0; k < need; k++)
+      {
+        int s = e_cand[k];
+        e_levels.move(e_energy[s], e_energy[s] - e_cost);
+        e_energy[s] -= e_cost;
+        e_busy[s >> 6] |= uint64_t(1) << (s & 63);
+        e_release.push(make_pair(task.getEND(), s));
+      }
+      e_mission_satis++;
+      return true;
+    }
+
+  public:
+
+    //SHIFT FUNCTION
+    //Description: Moves the sweep and every pending release delta time
+    //units earlier. A uniform shift keeps the heap's order.
+    void shiftTime(const int delta)
+    {
+      vector<pair<int, int> > pending; //Releases still waiting
+      while (!e_release.empty())
+      {
+        pending.push_back(e_release.top());
+        e_release.pop();
+      }
+      for (size_t j = 0; j < pending.size(); j++)
+      {
+        e_release.push(make_pair(pending[j].first - delta,
+                                 pending[j].second));
+      }
+      if (e_now != INT_MIN)
+      {
+        e_now -= delta;
+      }
+      return;
+    }
+
+    //LOW-ENERGY-SENSOR COUNTING FUNCTION
+    //Description: Returns the number of sensors that can no longer complete
+    //missions.
+    int calcLES(const int dura)const
+    {
+      return e_levels.countBelow(dura);
+    }
+
+    //ACCESSOR FUNCTIONS
+    int getMISSIONCOUNT()const{ return e_mission_count; }
+    int getMISSIONSATIS()const{ return e_mission_satis; }
+
+};
+
+///////////////////
+///SCENARIO_FILE///
+///////////////////
+
+//A scenario file holds a layout so it can be replayed across runs,
+//policies and versions. It is a ScenarioHeader followed by an array of
+//SensorRecords and then an array of MissionRecords, all in the host's
+//byte order. Every field is four bytes wide, so both arrays are aligned
+//and a memory mapped file is read in place, without parsing. The version
+//is raised whenever the layout changes.
+
+const char SCENARIO_MAGIC[4] = {'S', 'N', 'M', 'S'};
+const uint32_t SCENARIO_VERSION = 1;
+
+struct ScenarioHeader
+{
+  char magic[4]; //Always SCENARIO_MAGIC
+  uint32_t version; //Layout version, SCENARIO_VERSION
+  uint32_t sensor_count; //Number of SensorRecords
+  uint32_t mission_count; //Number of MissionRecords
+  int32_t aoi_w; //Width of the AoI
+  int32_t aoi_h; //Height of the AoI
+};
+
+struct SensorRecord
+{
+  float x; //Sensor's X coordinate
+  float y; //Sensor's Y coordinate
+  int32_t energy; //Energy level the sensor starts with
+};
+
+struct MissionRecord
+{
+  int32_t start; //Mission Start
+  int32_t end; //Mission End
+  float ex; //Mission Epicenter's X coordinate
+  float ey; //Mission Epicenter's Y coordinate
+};
+
+//LINE END FUNCTION
+//Description: Used after sscanf has read a line up to used characters,
+//as reported by %n. Returns true if only whitespace is left, so lines
+//with trailing junk can be rejected.
+bool endsAt(const string & line, const int used)
+{
+  return used > 0 && line.find_first_not_of(" \t\r", used) == string::npos;
+}
+
+//This object holds a loaded scenario. Binary files are memory mapped and
+//used as they are. Text files are converted to the same layout in memory.
+//A text file has one entry per line: "aoi W H", "sensor X Y [ENERGY]" or
+//"mission START END X Y". Blank lines and lines starting with '#' are
+//skipped. Sensors default to 1000 energy units, the AoI defaults to the
+//smallest one holding every sensor and epicenter, and missions are put in
+//order of start time.
+
+class ScenarioFile
+{
+  private:
+    void* f_map; //Mapped file, or NULL
+    size_t f_map_size; //Size of the mapping
+    vector<uint32_t> f_buffer; //Converted text file, kept word aligned
+    const ScenarioHeader* f_header; //Header of the loaded scenario
+    const SensorRecord* f_sensors; //First sensor record
+    const MissionRecord* f_missions; //First mission record
+
+    //Scenario files own their mapping, so they aren't copied.
+    ScenarioFile(const ScenarioFile &);
+    ScenarioFile & operator=(const ScenarioFile &);
+
+    //ATTACH FUNCTION
+    //Description: Checks that data holds a complete scenario of the
+    //current version, and points the records into it. Every record is
+    //checked as a text line would be: sensors have no negative energy and
+    //lie inside the AoI, and missions don't end before they start, last
+    //at most INT_MAX/2 and are in order of start time.
+    bool attach(const char* data, const size_t size, const char* path)
+    {
+      const ScenarioHeader* head =
+        reinterpret_cast<const ScenarioHeader*>(data);
+      if (size < sizeof(ScenarioHeader) ||
+          memcmp(head->magic, SCENARIO_MAGIC, 4) != 0)
+      {
+        cerr << path << " is not a scenario file" << endl;
+        return false;
+      }
+      if (head->version != SCENARIO_VERSION)
+      {
+        cerr << path << " has scenario version " << head->version
+             << ", expected " << SCENARIO_VERSION << endl;
+        return false;
+      }
+      uint64_t expected = sizeof(ScenarioHeader) +
+        uint64_t(head->sensor_count)*sizeof(SensorRecord) +
+        uint64_t(head->mission_count)*sizeof(MissionRecord);
+      bool valid = expected == size && head->aoi_w > 0 && head->aoi_h > 0;
+      const SensorRecord* sensors = reinterpret_cast<const SensorRecord*>(
+        data + sizeof(ScenarioHeader));
+      const MissionRecord* missions = reinterpret_cast<const MissionRecord*>(
+        data + sizeof(ScenarioHeader) +
+        size_t(head->sensor_count)*sizeof(SensorRecord));
+      for (uint32_t i = 0; valid && i < head->sensor_count; i++)
+      {
+        const SensorRecord & r = sensors[i];
+        valid = r.energy >= 0 && r.x >= 0 && r.x <= head->aoi_w &&
+                r.y >= 0 && r.y <= head->aoi_h; //Also false for NaN
+      }
+      for (uint32_t m = 0; valid && m < head->mission_count; m++)
+      {
+        const MissionRecord & r = missions[m];
+        valid = r.end >= r.start &&
+                int64_t(r.end) - r.start <= INT_MAX/2 &&
+                (m == 0 || r.start >= missions[m - 1].start);
+      }
+      if (!valid)
+      {
+        cerr << path << " is truncated or damaged" << endl;
+        return false;
+      }
+      f_header = head;
+      f_sensors = sensors;
+      f_missions = missions;
+      return true;
+    }
+
+    //TEXT IMPORT FUNCTION
+    //Description: Converts a text scenario into the binary layout, held
+    //in f_buffer.
+    bool importText(istream & in, const char* path)
+    {
+      vector<SensorRecord> sensors;
+      vector<MissionRecord> missions;
+      int aoi_w = 0, aoi_h = 0; //AoI given by the file, if any
+      float max_x = 0, max_y = 0; //Furthest coordinates seen
+      string line;
+      int line_num = 0;
+      while (getline(in, line))
+      {
+        line_num++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == string::npos || line[first] == '#')
+        {
+          continue;
+        }
+        char kind[16];
+        SensorRecord sr;
+        MissionRecord mr;
+        bool ok = false;
+        int used = 0; //Characters of the line parsed
+        if (sscanf(line.c_str(), "%15s", kind) != 1)
+        {
+          ok = false;
+        }
+        else if (strcmp(kind, "aoi") == 0)
+        {
+          ok = sscanf(line.c_str(), "%*s %d %d%n", &aoi_w, &aoi_h,
+                      &used) == 2 && endsAt(line, used) &&
+               aoi_w > 0 && aoi_h > 0;
+        }
+        else if (strcmp(kind, "sensor") == 0)
+        {
+          sr.energy = 1000;
+          int n = sscanf(line.c_str(), "%*s %f %f%n %d%n", &sr.x, &sr.y,
+                         &used, &sr.energy, &used); //Energy is optional
+          ok = n >= 2 && endsAt(line, used) && sr.energy >= 0;
+          if (ok)
+          {
+            sensors.push_back(sr);
+            max_x = max(max_x, sr.x);
+            max_y = max(max_y, sr.y);
+          }
+        }
+        else if (strcmp(kind, "mission") == 0)
+        {
+          ok = sscanf(line.c_str(), "%*s %d %d %f %f%n", &mr.start,
+                      &mr.end, &mr.ex, &mr.ey, &used) == 4 &&
+               endsAt(line, used) && mr.end >= mr.start;
+          if (ok)
+          {
+            missions.push_back(mr);
+            max_x = max(max_x, mr.ex);
+            max_y = max(max_y, mr.ey);
+          }
+        }
+        if (!ok)
+        {
+          cerr << "Bad scenario line " << line_num << " in " << path << ": "
+               << line << endl;
+          return false;
+        }
+      }
+      stable_sort(missions.begin(), missions.end(), startsEarlier);
+      ScenarioHeader head;
+      memcpy(head.magic, SCENARIO_MAGIC, 4);
+      head.version = SCENARIO_VERSION;
+      head.sensor_count = static_cast<uint32_t>(sensors.size());
+      head.mission_count = static_cast<uint32_t>(missions.size());
+      head.aoi_w = aoi_w > 0 ? aoi_w : static_cast<int>(ceil(max_x)) + 1;
+      head.aoi_h = aoi_h > 0 ? aoi_h : static_cast<int>(ceil(max_y)) + 1;
+      size_t size = sizeof(head) + sensors.size()*sizeof(SensorRecord) +
+                    missions.size()*sizeof(MissionRecord);
+      f_buffer.assign(size/sizeof(uint32_t), 0);
+      char* data = reinterpret_cast<char*>(f_buffer.data());
+      memcpy(data, &head, sizeof(head));
+      if (!sensors.empty())
+      {
+        memcpy(data + sizeof(head), sensors.data(),
+               sensors.size()*sizeof(SensorRecord));
+      }
+      if (!missions.empty())
+      {
+        memcpy(data + sizeof(head) + sensors.size()*sizeof(SensorRecord),
+               missions.data(), missions.size()*sizeof(MissionRecord));
+      }
+      return attach(data, size, path);
+    }
+
+    //START ORDER FUNCTION
+    //Description: Orders imported missions by start time.
+    static bool startsEarlier(const MissionRecord & a, const MissionRecord & b)
+    {
+      return a.start < b.start;
+    }
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    ScenarioFile()
+    {
+      f_map = NULL;
+      f_map_size = 0;
+      f_header = NULL;
+      f_sensors = NULL;
+      f_missions = NULL;
+    }
+
+    //DESTRUCTOR
+    ~ScenarioFile(){ close(); }
+
+    //LOAD FUNCTION
+    //Description: Loads a scenario file, memory mapping it if it is binary
+    //and converting it if it is text. Returns false, after writing the
+    //reason to cerr, if it can't be loaded.
+    bool load(const char* path)
+    {
+      close();
+      int fd = open(path, O_RDONLY);
+      if (fd < 0)
+      {
+        cerr << "Could not open scenario file " << path << endl;
+        return false;
+      }
+      struct stat info;
+      char magic[4] = {0, 0, 0, 0};
+      bool binary = fstat(fd, &info) == 0 &&
+                    read(fd, magic, 4) == 4 &&
+                    memcmp(magic, SCENARIO_MAGIC, 4) == 0;
+      if (!binary)
+      {
+        ::close(fd);
+        ifstream in(path);
+        return importText(in, path);
+      }
+      f_map_size = info.st_size;
+      f_map = mmap(NULL, f_map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd); //The mapping stays valid after the file is closed
+      if (f_map == MAP_FAILED)
+      {
+        f_map = NULL;
+        cerr << "Could not map scenario file " << path << endl;
+        return false;
+      }
+      if (!attach(static_cast<const char*>(f_map), f_map_size, path))
+      {
+        close();
+        return false;
+      }
+      return true;
+    }
+
+    //CLOSE FUNCTION
+    //Description: Releases the loaded scenario, if any.
+    void close()
+    {
+      if (f_map != NULL)
+      {
+        munmap(f_map, f_map_size);
+        f_map = NULL;
+      }
+      f_buffer.clear();
+      f_header = NULL;
+      f_sensors = NULL;
+      f_missions = NULL;
+    }
+
+    //SAVE FUNCTION
+    //Description: Writes a scenario file holding the given records.
+    //Returns false if it can't be written.
+    static bool save(const char* path, const int aoi_w, const int aoi_h,
+                     const SensorRecord* sensors, const int sensor_count,
+                     const MissionRecord* missions, const int mission_count)
+    {
+      ScenarioHeader head;
+      memcpy(head.magic, SCENARIO_MAGIC, 4);
+      head.version = SCENARIO_VERSION;
+      head.sensor_count = sensor_count;
+      head.mission_count = mission_count;
+      head.aoi_w = aoi_w;
+      head.aoi_h = aoi_h;
+      ofstream out(path, ios::binary);
+      out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+      out.write(reinterpret_cast<const char*>(sensors),
+                sensor_count*sizeof(SensorRecord));
+      out.write(reinterpret_cast<const char*>(missions),
+                mission_count*sizeof(MissionRecord));
+      out.close();
+      if (!out)
+      {
+        cerr << "Could not write scenario file " << path << endl;
+        return false;
+      }
+      return true;
+    }
+
+    //ACCESSOR FUNCTIONS
+    bool isLoaded()const{ return f_header != NULL; }
+    int getSENSORCOUNT()const{ return f_header->sensor_count; }
+    int getMISSIONCOUNT()const{ return f_header->mission_count; }
+    int getAOIW()const{ return f_header->aoi_w; }
+    int getAOIH()const{ return f_header->aoi_h; }
+    const SensorRecord & getSENSOR(const int i)const{ return f_sensors[i]; }
+    const MissionRecord & getMISSION(const int i)const
+    {
+      return f_missions[i];
+    }
+    const SensorRecord* getSENSORS()const{ return f_sensors; }
+    const MissionRecord* getMISSIONS()const{ return f_missions; }
+
+};
+
+//////////////
+///SCENARIO///
+//////////////
+
+//This object holds the sensors and missions generated for one trial. They
+//are drawn from the trial's own streams, one after another, so the first
+//n sensors are the same no matter how many are generated, and likewise
+//for the missions. A mission's duration and range are not drawn at all.
+//So a Scenario only has to generate more entries when a run asks for more
+//than it already holds, and a sweep over sensor counts, mission counts,
+//durations, ranges and sensors required per mission can reuse one layout
+//across all of its points. Only a change of seed, AoI or start time
+//variance starts the layout over.
+
+class Scenario
+{
+  private:
+    uint64_t sc_seed; //Seed the layout was generated from
+    int sc_trial; //Trial the layout belongs to, or -1 if none yet
+    const ScenarioFile* sc_file; //File the layout was copied from, if any
+    int sc_aoi_w; //AoI width the layout was generated in
+    int sc_aoi_h; //AoI height the layout was generated in
+    int sc_msv; //Maximum variance in start time used for the missions
+    int sc_last_start; //Start time of the last mission generated
+    RandGen sc_sensor_rng; //Sensor placement stream
+    RandGen sc_mission_rng; //Mission generation stream
+    vector<Sensor> sc_sensors; //Sensors generated so far
+    vector<Mission> sc_missions; //Missions generated so far
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    Scenario() : sc_sensor_rng(0), sc_mission_rng(0)
+    {
+      sc_seed = 0;
+      sc_trial = -1;
+      sc_file = NULL;
+      sc_aoi_w = 0;
+      sc_aoi_h = 0;
+      sc_msv = 0;
+      sc_last_start = 0;
+    }
+
+    //PREPARE FUNCTION
+    //Description: Makes sure the layout for the given trial holds at
+    //least num_sensors sensors and num_missions missions, generating only
+    //what is missing.
+    void prepare(const uint64_t seed, const int trial, const int aoi_w,
+                 const int aoi_h, const int msv, const int num_sensors,
+                 const int num_missions)
+    {
+      if (seed != sc_seed || trial != sc_trial || aoi_w != sc_aoi_w ||
+          aoi_h != sc_aoi_h || msv != sc_msv || sc_file != NULL)
+      { //Starts the layout over
+        sc_file = NULL;
+        sc_seed = seed;
+        sc_trial = trial;
+        sc_aoi_w = aoi_w;
+        sc_aoi_h = aoi_h;
+        sc_msv = msv;
+        sc_last_start = 0;
+        sc_sensor_rng = RandGen(seed, trial, RandGen::SENSOR_STREAM);
+        sc_mission_rng = RandGen(seed, trial, RandGen::MISSION_STREAM);
+        sc_sensors.clear();
+        sc_missions.clear();
+      }
+      while (static_cast<int>(sc_sensors.size()) < num_sensors)
+      {
+        sc_sensors.emplace_back(sc_sensor_rng, aoi_w, aoi_h);
+      }
+      while (static_cast<int>(sc_missions.size()) < num_missions)
+      {
+        sc_last_start += (sc_mission_rng.next()%msv);
+        sc_missions.emplace_back(sc_last_start, 0, 0.0f, aoi_w, aoi_h,
+                                 sc_mission_rng);
+      }
+      return;
+    }
+
+    //ADOPT FUNCTION
+    //Description: Makes the layout the first num_sensors sensors and
+    //num_missions missions of a scenario file. Unlike generated ones, these
+    //missions keep the duration recorded in the file.
+    void adopt(const ScenarioFile & file, const int num_sensors,
+               const int num_missions)
+    {
+      if (sc_file != &file)
+      {
+        sc_file = &file;
+        sc_trial = -1;
+        sc_sensors.clear();
+        sc_missions.clear();
+      }
+      while (static_cast<int>(sc_sensors.size()) < num_sensors)
+      {
+        const SensorRecord & r =
+          file.getSENSOR(static_cast<int>(sc_sensors.size()));
+        sc_sensors.emplace_back(r.x, r.y, r.energy);
+      }
+      while (static_cast<int>(sc_missions.size()) < num_missions)
+      {
+        const MissionRecord & r =
+          file.getMISSION(static_cast<int>(sc_missions.size()));
+        sc_missions.emplace_back(r.start, r.end - r.start, r.ex, r.ey, 0.0f);
+      }
+      return;
+    }
+
+    //ACCESSOR FUNCTIONS
+    const vector<Sensor> & getSENSORS()const{ return sc_sensors; }
+    const Mission & getMISSION(const int i)const{ return sc_missions[i]; }
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+/////////////////////////////TRIAL_RUNNER/////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//This is one class of missions in a mixed workload. A field left at 0
+//takes the run's value.
+struct MissionClass
+{
+  int duration; //Duration of the class's missions
+  float radius; //Range of the class's missions
+  int req; //Sensors each of the class's missions needs
+  double weight; //Share of the missions drawn from the class
+};
+
+//These parameters describe one run of the simulation. Every trial of a
+//run uses the same parameters, but its own sensors and missions.
+struct TrialSetup
+{
+  int duration; //Duration of every mission
+  int num_sensors; //Number of sensors in the network
+  int req_sens; //Sensors required per mission
+  int num_missions; //Number of missions per trial
+  float radius; //Mission's Range from Epicenter for Sensor Detection
+  int aoi_w; //Largest X-Coord within Area of Interest
+  int aoi_h; //Largest Y-Coord within Area of Interest
+  int msv; //Maximum Variance in Mission Start time
+  int num_trials; //Number of trials averaged together, or the fewest
+  float ci_width; //If above 0, widest 95% interval accepted, as a fraction
+  int max_trials; //Most trials run while narrowing the intervals
+  bool use_index; //If false, range queries scan every sensor
+  bool naive_offline; //If true, the offline loop recomputes every TE
+  int offline_threads; //If above 1, threads sharing the offline search
+  bool use_graph; //If true, an EligibilityGraph is built for each trial
+  bool sweep_line; //If true, the online pass uses the SweepLineScheduler
+  int batch_window; //If above 0, the window of the Batch Algorithm
+  const PolicyEntry* policy; //Extra policy to run, or NULL
+  const ScenarioFile* scenario_file; //Layout to use, or NULL to generate
+  vector<MissionClass> mix; //Classes missions are drawn from, if any
+  bool record_health; //If true, each trial records its health curves
+  string checkpoint_dir; //Directory trial snapshots are kept in, if any
+  double checkpoint_every; //Seconds between snapshots of an offline pass
+  bool resume; //If true, trials pick up from their snapshots
+  string checkpoint_key; //Settings every snapshot is written with
+  uint64_t seed; //Seed that every trial's generators are derived from
+};
+
+//These are the results of a single trial, one entry per algorithm.
+struct TrialResult
+{
+  int random_sat; //Missions satisfied by the Random Algorithm
+  int online_sat; //Missions satisfied by the Online Algorithm
+  int offline_sat; //Missions satisfied by the Offline Algorithm
+  int batch_sat; //Missions satisfied by the Batch Algorithm, if run
+  int policy_sat; //Missions satisfied by the chosen policy, if run
+  int random_les; //Low-energy sensors after the Random Algorithm
+  int online_les; //Low-energy sensors after the Online Algorithm
+  int offline_les; //Low-energy sensors after the Offline Algorithm
+  int batch_les; //Low-energy sensors after the Batch Algorithm, if run
+  int policy_les; //Low-energy sensors after the chosen policy, if run
+  int graph_edges; //Mission-sensor pairs in range, if a graph was built
+  size_t graph_bytes; //Memory held by the EligibilityGraph, if built
+  vector<HealthPoint> random_curve; //Health after each mission, if recorded
+  vector<HealthPoint> online_curve;
+  vector<HealthPoint> offline_curve;
+  bool resumed; //If true, the trial was picked up from a snapshot
+  int checkpoints; //Snapshots the trial wrote
+  double checkpoint_secs; //Time spent writing them
+  double offline_secs; //Time spent in the offline pass
+};
+
+//These are the counts of a TrialResult that partial files and trial
+//snapshots carry.
+const int NUM_COUNT_FIELDS = 10;
+int TrialResult::* const COUNT_FIELDS[NUM_COUNT_FIELDS] =
+  {&TrialResult::random_sat, &TrialResult::online_sat,
+   &TrialResult::offline_sat, &TrialResult::batch_sat,
+   &TrialResult::policy_sat, &TrialResult::random_les,
+   &TrialResult::online_les, &TrialResult::offline_les,
+   &TrialResult::batch_les, &TrialResult::policy_les};
+
+//These are the quantities a run estimates, each measured once per trial.
+enum Metric
+{
+  M_RANDOM_SR, M_ONLINE_SR, M_OFFLINE_SR, M_BATCH_SR, M_POLICY_SR,
+  M_RANDOM_LEP, M_ONLINE_LEP, M_OFFLINE_LEP, M_BATCH_LEP, M_POLICY_LEP,
+  NUM_METRICS
+};
+
+//Names of the metrics, as used in sweep output
+const char* const METRIC_NAMES[NUM_METRICS] =
+  {"random_sat", "online_sat", "offline_sat", "batch_sat", "policy_sat",
+   "random_low_energy", "online_low_energy", "offline_low_energy",
+   "batch_low_energy", "policy_low_energy"};
+
+//This object keeps the running mean and variance of a series of values by
+//Welford's method, which stays accurate however many values are added.
+class RunningStat
+{
+  private:
+    int r_count; //Values added
+    double r_mean; //Mean of the values
+    double r_m2; //Sum of squared differences from the mean
+
+  public:
+
+    //DEFAULT CONSTRUCTOR
+    RunningStat()
+    {
+      r_count = 0;
+      r_mean = 0;
+      r_m2 = 0;
+    }
+
+    //ADD FUNCTION
+    //Description: Adds a value to the series.
+    void add(const double x)
+    {
+      r_count++;
+      double delta = x - r_mean;
+      r_mean += delta/r_count;
+      r_m2 += delta*(x - r_mean);
+    }
+
+    //HALF WIDTH FUNCTION
+    //Description: Returns half the width of the 95% confidence interval of
+    //the mean, using Student's t distribution. Fewer than two values give
+    //no estimate of spread, so the interval is infinite.
+    double halfWidth()const
+    {
+      static const double T95[30] = //Two-sided 95% points for 1-30 d.o.f.
+        {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262,
+         2.228, 2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101,
+         2.093, 2.086, 2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052,
+         2.048, 2.045, 2.042};
+      if (r_count < 2)
+      {
+        return HUGE_VAL;
+      }
+      double t = r_count - 1 <= 30 ? T95[r_count - 2] : 1.960;
+      return t*sqrt(r_m2/(r_count - 1)/r_count);
+    }
+
+    //ACCESSOR FUNCTIONS
+    int getCOUNT()const{ return r_count; }
+    double getMEAN()const{ return r_mean; }
+};
+
+//This object keeps a RunningStat for every metric of a run, fed with one
+//trial at a time.
+class TrialStats
+{
+  private:
+    RunningStat ts_stat[NUM_METRICS]; //Series of each metric
+
+  public:
+
+    //ADD FUNCTION
+    //Description: Adds a trial's rates to each series.
+    void add(const TrialSetup & setup, const TrialResult & r)
+    {
+      const int sat[5] = {r.random_sat, r.online_sat, r.offline_sat,
+                          r.batch_sat, r.policy_sat};
+      const int les[5] = {r.random_les, r.online_les, r.offline_les,
+                          r.batch_les, r.policy_les};
+      for (int a = 0; a < 5; a++)
+      {
+        ts_stat[M_RANDOM_SR + a].add(static_cast<double>(sat[a])/
+                                     setup.num_missions);
+        ts_stat[M_RANDOM_LEP + a].add(static_cast<double>(les[a])/
+                                      setup.num_sensors);
+      }
+    }
+
+    //PRECISION FUNCTION
+    //Description: Tests if the 95% interval of every metric the run
+    //measures is at most width wide.
+    bool precise(const TrialSetup & setup, const double width)const
+    {
+      for (int m = 0; m < NUM_METRICS; m++)
+      {
+        if (measured(setup, static_cast<Metric>(m)) &&
+            2*ts_stat[m].halfWidth() > width)
+        {
+          return false;
+        }
+      }
+      return true;
+    }
+
+    //MEASURED FUNCTION
+    //Description: Tests if a run with the passed setup measures a metric.
+    static bool measured(const TrialSetup & setup, const Metric m)
+    {
+      if (m == M_BATCH_SR || m == M_BATCH_LEP)
+      {
+        return setup.batch_window > 0;
+      }
+      if (m == M_POLICY_SR || m == M_POLICY_LEP)
+      {
+        return setup.policy != NULL;
+      }
+      return true;
+    }
+
+    const RunningStat & getSTAT(const Metric m)const{ return ts_stat[m]; }
+};
+
+//These are the averaged results of every trial in a run. Rates are
+//fractions, not percents.
+struct RunSummary
+{
+  float random_sr; //Satisfaction Rate of the Random Algorithm
+  float online_sr; //Satisfaction Rate of the Online Algorithm
+  float offline_sr; //Satisfaction Rate of the Offline Algorithm
+  float batch_sr; //Satisfaction Rate of the Batch Algorithm
+  float policy_sr; //Satisfaction Rate of the chosen policy
+  float random_lep; //Low Energy Percent of the Random Algorithm
+  float online_lep; //Low Energy Percent of the Online Algorithm
+  float offline_lep; //Low Energy Percent of the Offline Algorithm
+  float batch_lep; //Low Energy Percent of the Batch Algorithm
+  float policy_lep; //Low Energy Percent of the chosen policy
+  float half_width[NUM_METRICS]; //Half of each metric's 95% interval
+  int graph_edges; //Edges in the largest EligibilityGraph built
+  size_t graph_bytes; //Memory used by the largest EligibilityGraph built
+};
+
+//These are the objects a trial works in. Each thread keeps one for every
+//trial it runs, so the memory held by the mission list, the network and
+//its arena, and the schedulers is reused rather than allocated again.
+struct TrialWorkspace
+{
+  vector<Mission> list; //An vector that stores all of the missions.
+  Network net; //The WSN, which contains all the sensors.
+  EligibilityGraph graph; //Sensors in range of each mission
+  OfflineScheduler offline; //Runs the Offline Algorithm
+  ParallelOfflineScheduler parallel; //Runs it on several threads
+  SweepLineScheduler sweep; //Runs the event driven Online Algorithm
+  BatchScheduler batch; //Runs the Batch Algorithm
+};
+
+//MISSION LIST FUNCTION
+//Description: Fills list with the missions of a trial, placed as in its
+//Scenario. With a mix, each mission's class is drawn by weight from the
+//trial's own stream, and sets the mission's duration, radius and demand.
+//Otherwise every mission uses the run's duration and radius, and loaded
+//missions keep the duration they were saved with.
+void buildMissions(const TrialSetup & setup, const int trial,
+                   const Scenario & scenario, vector<Mission> & list)
+{
+  RandGen mix_rng(setup.seed, trial, RandGen::MIX_STREAM);
+  double total = 0; //Sum of the class weights
+  for (size_t c = 0; c < setup.mix.size(); c++)
+  {
+    total += setup.mix[c].weight;
+  }
+  list.clear(); //Keeps the memory of the thread's last trial
+  list.reserve(setup.num_missions);
+  for (int i = 0; i < setup.num_missions; i++) //Mission Generation
+  {
+    const Mission & layout = scenario.getMISSION(i);
+    int dura = setup.scenario_file != NULL ? //Loaded missions keep theirs
+               layout.getEND() - layout.getSTART() : setup.duration;
+    float rad = setup.radius;
+    int req = 0; //Uses the run's demand
+    if (!setup.mix.empty())
+    {
+      double pick = mix_rng.next()/(RNG_MAX + 1.0)*total;
+      size_t c = 0;
+      while (c + 1 < setup.mix.size() && pick >= setup.mix[c].weight)
+      {
+        pick -= setup.mix[c].weight;
+        c++;
+      }
+      const MissionClass & type = setup.mix[c];
+      dura = type.duration > 0 ? type.duration : dura;
+      rad = type.radius > 0 ? type.radius : rad;
+      req = type.req;
+    }
+    list.emplace_back(layout.getSTART(), dura, layout.getEX(),
+                      layout.getEY(), rad);
+    list.back().setREQ(req);
+  }
+  return;
+}
+
+//This is the record a trial's snapshots lead with, followed by the run's
+//settings. Snapshots taken during the offline pass leave finished at 0,
+//hold the Random and Online Algorithms' results and are followed by the
+//pass's state. When the trial ends its snapshot is replaced by one
+//holding all of its results, so a resumed run skips it.
+struct TrialRecord
+{
+  int32_t trial; //Trial the snapshot belongs to
+  int32_t finished; //1 once every algorithm has run
+  int32_t counts[NUM_COUNT_FIELDS]; //Results of the algorithms run so far
+  int32_t graph_edges; //Size of the EligibilityGraph, once finished
+  int64_t graph_bytes;
+  uint64_t seed; //Seed the trial's generators are derived from
+  uint64_t random_state; //Random Algorithm's generator after its pass
+};
+
+//SNAPSHOT SEED FUNCTION
+//Description: Reads the seed a snapshot was written with into seed.
+//Returns false if the file is missing or damaged.
+bool snapshotSeed(const string & path, uint64_t & seed)
+{
+  string header;
+  TrialRecord record;
+  if (!OfflineCheckpoint::load(path, header, NULL, NULL) ||
+      header.size() < sizeof(record))
+  {
+    return false;
+  }
+  memcpy(&record, header.data(), sizeof(record));
+  seed = record.seed;
+  return true;
+}
+
+//SNAPSHOT PATH FUNCTION
+//Description: Returns the file a trial's snapshots are written to.
+string snapshotPath(const TrialSetup & setup, const int trial)
+{
+  ostringstream path;
+  path << setup.checkpoint_dir << "/trial-" << trial << ".snap";
+  return path.str();
+}
+
+//TRIAL HEADER FUNCTION
+//Description: Returns the header of a trial's snapshots, with the
+//results in r so far and the state of the trial's Random Algorithm
+//generator.
+string trialHeader(const TrialSetup & setup, const int trial,
+                   const bool finished, const TrialResult & r,
+                   const RandGen & random_rng)
+{
+  TrialRecord record;
+  memset(&record, 0, sizeof(record)); //Padding is written too
+  record.trial = trial;
+  record.finished = finished;
+  for (int f = 0; f < NUM_COUNT_FIELDS; f++)
+  {
+    record.counts[f] = r.*COUNT_FIELDS[f];
+  }
+  if (finished)
+  {
+    record.graph_edges = r.graph_edges;
+    record.graph_bytes = r.graph_bytes;
+  }
+  record.seed = setup.seed;
+  record.random_state = random_rng.getSTATE();
+  return string(reinterpret_cast<const char*>(&record), sizeof(record)) +
+         setup.checkpoint_key;
+}
+
+//TRIAL HEADER READING FUNCTION
+//Description: Reads a header written by trialHeader, filling in the
+//results in r and restoring random_rng. Returns false if the header
+//belongs to another trial or to a run with other settings.
+bool readTrialHeader(const string & header, const TrialSetup & setup,
+                     const int trial, bool & finished, TrialResult & r,
+                     RandGen & random_rng)
+{
+  TrialRecord record;
+  if (header.size() < sizeof(record) ||
+      header.compare(sizeof(record), string::npos, setup.checkpoint_key) != 0)
+  {
+    return false;
+  }
+  memcpy(&record, header.data(), sizeof(record));
+  if (record.trial != trial || record.seed != setup.seed)
+  {
+    return false;
+  }
+  finished = record.finished != 0;
+  for (int f = 0; f < NUM_COUNT_FIELDS; f++)
+  {
+    r.*COUNT_FIELDS[f] = record.counts[f];
+  }
+  random_rng.setSTATE(record.random_state);
+  if (finished)
+  {
+    r.graph_edges = record.graph_edges;
+    r.graph_bytes = static_cast<size_t>(record.graph_bytes);
+  }
+  return true;
+}
+
+//TRIAL FUNCTION
+//Description: Runs all three algorithms on a network and mission list
+//taken from the trial's Scenario. Everything a trial touches is owned by
+//the trial or its thread's workspace, so trials can run concurrently on
+//different threads. With a checkpoint directory, the offline pass takes
+//snapshots, and when resuming, a finished trial's results are read back
+//and an unfinished trial's offline pass continues from its snapshot. The
+//snapshot holds the Random and Online Algorithms' results and the Random
+//Algorithm's generator, so those passes are not run again.
+void runTrial(const TrialSetup & setup, const int trial, Scenario & scenario,
+              TrialWorkspace & work, TrialResult & out)
+{
+  RandGen random_rng(setup.seed, trial, RandGen::RANDOM_STREAM);
+  vector<Mission> & List = work.list;
+  Network & WSN = work.net;
+  EligibilityGraph & graph = work.graph;
+  OfflineScheduler & offline = work.offline;
+  SweepLineScheduler & sweep = work.sweep;
+  WSN.setSpatialIndex(setup.use_index);
+  int m_count = setup.num_missions; //Number of missions
+  int index = 0; //Current mission being considered
+  SNMS_PHASE_TIMER(timer); //Times each phase of the trial
+
+  /*-----CHECKPOINT LOOKUP-----*/
+  string snapshot; //File the trial's snapshots go to, if any
+  bool restore = false; //If true, the offline pass resumes from snapshot
+  out.resumed = false;
+  out.checkpoints = 0;
+  out.checkpoint_secs = 0;
+  out.offline_secs = 0;
+  for (int f = 0; f < NUM_COUNT_FIELDS; f++)
+  {
+    out.*COUNT_FIELDS[f] = 0;
+  }
+  if (!setup.checkpoint_dir.empty())
+  {
+    snapshot = snapshotPath(setup, trial);
+    string header;
+    bool finished = false;
+    if (setup.resume && OfflineCheckpoint::load(snapshot, header, NULL, NULL)
+        && readTrialHeader(header, setup, trial, finished, out,
+                           random_rng))
+    {
+      out.resumed = true;
+      if (finished)
+      {
+        return;
+      }
+      restore = true;
+    }
+  }
+
+  /*-----NETWORK GENERATION-----*/
+  SNMS_PHASE(timer, P_GENERATION);
+  if (setup.scenario_file != NULL)
+  {
+    scenario.adopt(*setup.scenario_file, setup.num_sensors, m_count);
+  }
+  else
+  {
+    scenario.prepare(setup.seed, trial, setup.aoi_w, setup.aoi_h, setup.msv,
+                     setup.num_sensors, m_count);
+  }
+  WSN.setGeometry(setup.aoi_w, setup.aoi_h);
+  WSN.addSensors(scenario.getSENSORS(), setup.num_sensors);
+
+  /*-----MISSION LIST GENERATION-----*/
+  buildMissions(setup, trial, scenario, List);
+
+  /*-----ELIGIBILITY GRAPH-----*/
+  SNMS_PHASE(timer, P_GRAPH);
+  out.graph_edges = 0;
+  out.graph_bytes = 0;
+  if (setup.use_graph)
+  {
+    graph.build(WSN, List);
+    WSN.attachGraph(&graph);
+    out.graph_edges = graph.getEDGES();
+    out.graph_bytes = graph.memoryBytes();
+  }
+
+  if (!restore) //A restored trial already has these results
+  {
+    /*-----RANDOM APPROACH-----*/
+    SNMS_PHASE(timer, P_RANDOM);
+    WSN.trackHealth(setup.duration,
+                    setup.record_health ? &out.random_curve : NULL);
+    while (index < m_count) //While there are more missions
+    {
+      WSN.randomAssign(List[index], setup.req_sens, random_rng);
+      index++;
+    }
+    out.random_sat = WSN.getMISSIONSATIS(); //Stores total satisfied missions
+    out.random_les = WSN.calcLES(setup.duration);
+
+    /*-----DATA PREP-----*/
+    SNMS_PHASE(timer, P_CLEANUP);
+    index = 0;
+    WSN.resetNetwork();
+    for (int q = 0; q < m_count; q++)
+    {
+      List[q].attempted = false;
+    }
+
+    /*-----ONLINE APPROACH-----*/
+    SNMS_PHASE(timer, P_ONLINE);
+    WSN.trackHealth(setup.duration,
+                    setup.record_health ? &out.online_curve : NULL);
+    if (setup.sweep_line)
+    {
+      sweep.reset(WSN);
+      sweep.trackHealth(setup.duration,
+                        setup.record_health ? &out.online_curve : NULL);
+      for (; index < m_count; index++) //Missions are in order of start time
+      {
+        sweep.process(List[index], setup.req_sens);
+      }
+      out.online_sat = sweep.getMISSIONSATIS();
+      out.online_les = sweep.calcLES(setup.duration);
+    }
+    while (index < m_count) //While there are more missions
+    {
+      WSN.missionAssign(List[index], setup.req_sens); //Attempts mission
+      index++;
+    }
+    if (!setup.sweep_line)
+    {
+      out.online_sat = WSN.getMISSIONSATIS(); //Stores total satisfied missions
+      out.online_les = WSN.calcLES(setup.duration);
+    }
+  }
+
+  /*-----DATA PREP-----*/
+  SNMS_PHASE(timer, P_CLEANUP);
+  index = 0;
+  WSN.resetNetwork();
+  for (int q = 0; q < m_count; q++)
+  {
+    List[q].attempted = false;
+  }
+
+  /*-----OFFLINE APPROACH-----*/
+  SNMS_PHASE(timer, P_OFFLINE);
+  WSN.trackHealth(setup.duration,
+                  setup.record_health ? &out.offline_curve : NULL);
+  OfflineCheckpoint checkpoint; //Takes the pass's snapshots
+  OfflineCheckpoint* saver = NULL; //The checkpoint, if snapshots are taken
+  if (!setup.checkpoint_dir.empty())
+  {
+    string header;
+    if (restore && !OfflineCheckpoint::load(snapshot, header, &WSN, &List))
+    {
+      cerr << "Could not restore " << snapshot << ", restarting trial "
+           << trial << "'s offline pass" << endl;
+      WSN.resetNetwork();
+      for (int q = 0; q < m_count; q++)
+      {
+        List[q].attempted = false;
+      }
+    }
+    checkpoint.start(snapshot, setup.checkpoint_every,
+                     trialHeader(setup, trial, false, out,
+                                 random_rng));
+    saver = &checkpoint;
+  }
+  chrono::steady_clock::time_point offline_start =
+    chrono::steady_clock::now();
+  int offcount = 0; //Used to count missions completed by offline algorithm
+  for (int q = 0; q < m_count; q++) //Counts any restored attempts
+  {
+    offcount += List[q].attempted;
+  }
+  if (setup.offline_threads > 1)
+  {
+    work.parallel.run(WSN, List, setup.req_sens, setup.offline_threads,
+                      saver);
+    offcount = m_count;
+  }
+  else if (!setup.naive_offline)
+  {
+    offline.run(WSN, List, setup.req_sens,
+                setup.use_graph ? &graph : NULL, saver);
+    offcount = m_count;
+  }
+  while (offcount < m_count) //While there are more missions
+  {
+    index = 0; //Index is reset
+    int maxTE = 0; //Stores calculated max TE
+    for (int i = 0; i < m_count; i++) //This loop finds the maximum TE
+    {
+      int currentTE = WSN.calcTE(List[i], setup.req_sens); //Current TE
+      if (currentTE >= maxTE && List[i].attempted == false)
+      { //If the currentTE exceeds maxTE and that mission hasn't been chosen
+        maxTE = currentTE; //Max TE updated
+        index = i; //Index of mission with MAX TE updated
+      }
+    }
+    WSN.missionAssign(List[index], setup.req_sens); //Attempts mission
+    offcount++; //Additional mission attempt recorded
+    if (saver != NULL)
+    {
+      saver->tick(WSN, List);
+    }
+  }
+  out.offline_secs = chrono::duration<double>(chrono::steady_clock::now() -
+                                              offline_start).count();
+  out.offline_sat = WSN.getMISSIONSATIS(); //Stores total satisfied missions
+  out.offline_les = WSN.calcLES(setup.duration);
+  WSN.trackHealth(setup.duration, NULL);
+
+  /*-----BATCH APPROACH-----*/
+  out.batch_sat = 0;
+  out.batch_les = 0;
+  if (setup.batch_window > 0)
+  {
+    SNMS_PHASE(timer, P_CLEANUP);
+    WSN.resetNetwork();
+    for (int q = 0; q < m_count; q++)
+    {
+      List[q].attempted = false;
+    }
+    SNMS_PHASE(timer, P_BATCH);
+    work.batch.run(WSN, List, setup.req_sens, setup.batch_window);
+    out.batch_sat = WSN.getMISSIONSATIS();
+    out.batch_les = WSN.calcLES(setup.duration);
+  }
+
+  /*-----CHOSEN POLICY-----*/
+  out.policy_sat = 0;
+  out.policy_les = 0;
+  if (setup.policy != NULL)
+  {
+    SNMS_PHASE(timer, P_CLEANUP);
+    WSN.resetNetwork();
+    for (int q = 0; q < m_count; q++)
+    {
+      List[q].attempted = false;
+    }
+    SNMS_PHASE(timer, P_POLICY);
+    RandGen policy_rng(setup.seed, trial, RandGen::POLICY_STREAM);
+    setup.policy->run(WSN, List, setup.req_sens, policy_rng,
+                      setup.use_graph ? &graph : NULL);
+    out.policy_sat = WSN.getMISSIONSATIS();
+    out.policy_les = WSN.calcLES(setup.duration);
+  }
+
+  /*-----DATA CLEANUP-----*/
+  SNMS_PHASE(timer, P_CLEANUP);
+  if (saver != NULL) //Replaces the last snapshot with the results
+  {
+    checkpoint.setHEADER(trialHeader(setup, trial, true, out, random_rng));
+    checkpoint.save(NULL, NULL);
+    out.checkpoints = checkpoint.getCOUNT();
+    out.checkpoint_secs = checkpoint.getCOST();
+  }
+  WSN.clearNetwork(); //Deletes all sensors, resets data.
+  return;
+}
+
+//TRIAL LIST FUNCTION
+//Description: Runs the listed trials on a pool of num_threads threads.
+//Threads claim the next unstarted trial until none are left, and each
+//result is stored in its trial's slot, which is added if needed. Trial t
+//always uses scenarios[t], so layouts carry over between runs that share
+//a scenario list. Since a trial's outcome depends only on its seed and
+//number, the results do not depend on the number of threads used.
+void runTrialList(const TrialSetup & setup, const int num_threads,
+                  const vector<int> & trials, vector<Scenario> & scenarios,
+                  vector<TrialResult> & results)
+{
+  int num_listed = static_cast<int>(trials.size()); //Trials to run
+  int last = 0; //One past the highest trial listed
+  for (int k = 0; k < num_listed; k++)
+  {
+    last = max(last, trials[k] + 1);
+  }
+  if (static_cast<int>(scenarios.size()) < last)
+  {
+    scenarios.resize(last);
+  }
+  if (static_cast<int>(results.size()) < last)
+  {
+    results.resize(last);
+  }
+  atomic<int> next_trial(0); //Next entry of trials to be claimed
+  vector<thread> pool;
+  for (int t = 0; t < num_threads; t++)
+  {
+    pool.push_back(thread([&]()
+    {
+      TrialWorkspace work; //Reused by every trial this thread runs
+      int k;
+      while ((k = next_trial.fetch_add(1)) < num_listed)
+      {
+        int trial = trials[k];
+        runTrial(setup, trial, scenarios[trial], work, results[trial]);
+      }
+      SNMS_FLUSH();
+    }));
+  }
+  for (size_t t = 0; t < pool.size(); t++)
+  {
+    pool[t].join();
+  }
+  return;
+}
+
+//TRIAL RANGE FUNCTION
+//Description: Runs trials first up to last, as runTrialList does, and
+//drops the results of any trials after them.
+void runTrialRange(const TrialSetup & setup, const int num_threads,
+                   const int first, const int last,
+                   vector<Scenario> & scenarios,
+                   vector<TrialResult> & results)
+{
+  vector<int> trials;
+  for (int t = first; t < last; t++)
+  {
+    trials.push_back(t);
+  }
+  results.resize(last);
+  runTrialList(setup, num_threads, trials, scenarios, results);
+  return;
+}
+
+//TRIAL RUNNER FUNCTION
+//Description: Runs the trials of a run. Normally that is num_trials
+//trials. If setup.ci_width is set, trials continue past num_trials until
+//every measured metric's 95% interval is at most ci_width wide, or
+//max_trials have run. Trials are run a batch at a time, but the stopping
+//point is found by adding results in trial order and any trials past it
+//are dropped, so the trials kept do not depend on the number of threads.
+void runTrials(const TrialSetup & setup, const int num_threads,
+               vector<Scenario> & scenarios, vector<TrialResult> & results)
+{
+  results.clear();
+  if (setup.ci_width <= 0)
+  {
+    runTrialRange(setup, num_threads, 0, setup.num_trials, scenarios,
+                  results);
+    return;
+  }
+  int max_trials = max(setup.max_trials, 1); //Trials allowed
+  int min_trials = min(setup.num_trials, max_trials); //Trials required
+  TrialStats stats; //Spread of each metric over the trials so far
+  int done = 0; //Trials run so far
+  while (true)
+  {
+    int batch = max(num_threads, min_trials - done); //Trials to run next
+    batch = min(batch, max_trials - done);
+    runTrialRange(setup, num_threads, done, done + batch, scenarios,
+                  results);
+    for (int t = done; t < done + batch; t++)
+    {
+      stats.add(setup, results[t]);
+      if ((t + 1 >= min_trials && stats.precise(setup, setup.ci_width)) ||
+          t + 1 >= max_trials)
+      {
+        results.resize(t + 1);
+        return;
+      }
+    }
+    done += batch;
+  }
+}
+
+//SUMMARY FUNCTION
+//Description: Averages the results of every trial in a run.
+void summarize(const TrialSetup & setup, const vector<TrialResult> & results,
+               RunSummary & sum)
+{
+  int randomSA = 0;  //The three variables on the left are used to store the
+  int onlineSA = 0;  //Satisfaction Average, or the average amount of missions
+  int offlineSA = 0; //that were satisfied each iteration.
+  
+  int randomLEA = 0; //These three variables store the percentage of low-energy
+  int onlineLEA = 0; //sensors for the three algorithms on average after each
+  int offlineLEA = 0;//iteration.
+  int batchSA = 0; //Totals of the Batch Algorithm, if it was run
+  int batchLEA = 0;
+  int policySA = 0; //Totals of the chosen policy, if it was run
+  int policyLEA = 0;
+
+  TrialStats stats; //Spread of each metric across the trials
+  sum.graph_edges = 0; //Largest EligibilityGraph, the earliest on ties
+  sum.graph_bytes = 0;
+  for (size_t t = 0; t < results.size(); t++)
+  {
+    stats.add(setup, results[t]);
+    randomSA += results[t].random_sat;
+    onlineSA += results[t].online_sat;
+    offlineSA += results[t].offline_sat;
+    randomLEA += results[t].random_les;
+    onlineLEA += results[t].online_les;
+    offlineLEA += results[t].offline_les;
+    batchSA += results[t].batch_sat;
+    batchLEA += results[t].batch_les;
+    policySA += results[t].policy_sat;
+    policyLEA += results[t].policy_les;
+    if (results[t].graph_edges > sum.graph_edges)
+    {
+      sum.graph_edges = results[t].graph_edges;
+      sum.graph_bytes = results[t].graph_bytes;
+    }
+  }
+  float missions = static_cast<float>(results.size()*setup.num_missions);
+  float sensors = static_cast<float>(results.size()*setup.num_sensors);
+  sum.random_sr = static_cast<float>(randomSA)/missions;
+  sum.online_sr = static_cast<float>(onlineSA)/missions;
+  sum.offline_sr = static_cast<float>(offlineSA)/missions;
+  sum.random_lep = static_cast<float>(randomLEA)/sensors;
+  sum.online_lep = static_cast<float>(onlineLEA)/sensors;
+  sum.offline_lep = static_cast<float>(offlineLEA)/sensors;
+  sum.batch_sr = static_cast<float>(batchSA)/missions;
+  sum.batch_lep = static_cast<float>(batchLEA)/sensors;
+  sum.policy_sr = static_cast<float>(policySA)/missions;
+  sum.policy_lep = static_cast<float>(policyLEA)/sensors;
+  for (int m = 0; m < NUM_METRICS; m++)
+  {
+    sum.half_width[m] = stats.getSTAT(static_cast<Metric>(m)).halfWidth();
+  }
+  return;
+}
+
+//RESULT LINE FUNCTION
+//Description: Writes one averaged result as a percent, followed by its
+//95% interval, clipped to the range a rate can take.
+void writeResult(ostream & out, const string & what, const float rate,
+                 const float half_width)
+{
+  out << what << rate*100 << "%";
+  if (half_width < HUGE_VAL)
+  {
+    out << " (95% CI " << max(rate - half_width, 0.0f)*100 << "% to "
+        << min(rate + half_width, 1.0f)*100 << "%)";
+  }
+  out << endl;
+  return;
+}
+
+//HEALTH CURVE FUNCTION
+//Description: Writes the health of each algorithm's network after every
+//mission as CSV, averaged over the trials. Low energy is given as a
+//percent of the sensors, and the median energy in energy units. Missions
+//are counted in the order each algorithm attempted them.
+void writeHealth(const TrialSetup & setup,
+                 const vector<TrialResult> & results, ostream & out)
+{
+  const vector<HealthPoint> TrialResult::* curves[3] =
+    {&TrialResult::random_curve, &TrialResult::online_curve,
+     &TrialResult::offline_curve};
+  float trials = static_cast<float>(results.size());
+  float sensors = trials*setup.num_sensors;
+  out << "mission,random_low_energy,online_low_energy,offline_low_energy,"
+      << "random_median_energy,online_median_energy,offline_median_energy"
+      << endl;
+  for (int m = 0; m < setup.num_missions; m++)
+  {
+    long long low[3] = {0, 0, 0}; //Totals across the trials
+    long long median[3] = {0, 0, 0};
+    for (size_t t = 0; t < results.size(); t++)
+    {
+      for (int a = 0; a < 3; a++)
+      {
+        const HealthPoint & point = (results[t].*curves[a])[m];
+        low[a] += point.low_energy;
+        median[a] += point.median_energy;
+      }
+    }
+    out << m + 1;
+    for (int a = 0; a < 3; a++)
+    {
+      out << "," << low[a]*100/sensors;
+    }
+    for (int a = 0; a < 3; a++)
+    {
+      out << "," << median[a]/trials;
+    }
+    out << endl;
+  }
+  return;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////SWEEP_MODE//////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//A sweep runs every combination of a set of parameter values and streams
+//one CSV or JSON row per combination. Each parameter is given as a single
+//value, a comma separated list, or an inclusive range "first:last:step".
+
+//These are the values each swept parameter takes.
+struct SweepSpec
+{
+  vector<double> duration; //Mission durations
+  vector<double> sensors; //Network sizes
+  vector<double> req_sens; //Sensors required per mission
+  vector<double> missions; //Mission counts
+  vector<double> radius; //Mission ranges
+  vector<double> aoi; //AoI sizes, used as both width and height
+};
+
+//These are all the settings of a run, as read from the command line and
+//any configuration file.
+struct RunOptions
+{
+  TrialSetup base; //Settings that aren't swept
+  SweepSpec sweep; //Values of the swept parameters
+  int num_threads; //Size of thread pool
+  bool seeded; //If true, the seed was given rather than taken from the time
+  bool sweep_mode; //If true, runs a sweep rather than asking for input
+  bool json; //If true, sweep rows are written as JSON rather than CSV
+  long long stream_count; //Missions to stream, 0 for a regular run
+  string stream_input; //File missions are streamed from, "-" for stdin
+  long long report_every; //Missions between streaming progress rows
+  bool pipeline; //If true, a stream's stages run on their own threads
+  string scenario_path; //Scenario file to load, if any
+  string save_path; //File to save the scenario to, if any
+  string health_path; //File the health curves are written to, if any
+  int shard_index; //Shard to run with --shard, or -1
+  int shard_count; //Number of shards the sweep is split into, or 0
+  string shard_dir; //Directory shared by shard workers, if any
+  int workers; //Worker processes started in the shard directory
+  bool merge; //If true, merges partial files rather than running
+  vector<string> merge_paths; //Partial files to merge, if any
+};
+
+//LIST PARSING FUNCTION
+//Description: Parses a value, list or range into out. Returns false if
+//the text isn't valid.
+bool parseList(const string & text, vector<double> & out)
+{
+  out.clear();
+  size_t pos = 0;
+  while (pos <= text.size())
+  {
+    size_t comma = text.find(',', pos);
+    if (comma == string::npos)
+    {
+      comma = text.size();
+    }
+    string item = text.substr(pos, comma - pos);
+    double first, last, step;
+    char extra;
+    if (sscanf(item.c_str(), "%lf:%lf:%lf%c", &first, &last, &step,
+               &extra) == 3)
+    {
+      if (step <= 0 || last < first)
+      {
+        return false;
+      }
+      for (int k = 0; first + k*step <= last + 1e-9; k++)
+      {
+        out.push_back(first + k*step);
+      }
+    }
+    else if (sscanf(item.c_str(), "%lf%c", &first, &extra) == 1)
+    {
+      out.push_back(first);
+    }
+    else
+    {
+      return false;
+    }
+    pos = comma + 1;
+  }
+  return !out.empty();
+}
+
+//MIX PARSING FUNCTION
+//Description: Parses a mixed workload given as comma separated
+//"duration:radius:req:weight" classes into out. A 0 field takes the run's
+//value. Returns false if the text isn't valid.
+bool parseMix(const string & text, vector<MissionClass> & out)
+{
+  out.clear();
+  istringstream in(text);
+  string item;
+  while (getline(in, item, ','))
+  {
+    MissionClass type;
+    char extra;
+    if (sscanf(item.c_str(), "%d:%f:%d:%lf%c", &type.duration, &type.radius,
+               &type.req, &type.weight, &extra) != 4 || type.duration < 0 ||
+        type.radius < 0 || type.req < 0 || !(type.weight > 0))
+    {
+      return false;
+    }
+    out.push_back(type);
+  }
+  return !out.empty();
+}
+
+//OPTION FUNCTION
+//Description: Applies one setting, given by name without leading dashes,
+//to the run options. Returns false if the name or value isn't valid.
+bool applyOption(const string & key, const string & value, RunOptions & opt)
+{
+  vector<double>* list = NULL; //Swept parameter being set, if any
+  if (key == "duration") list = &opt.sweep.duration;
+  else if (key == "sensors") list = &opt.sweep.sensors;
+  else if (key == "req") list = &opt.sweep.req_sens;
+  else if (key == "missions") list = &opt.sweep.missions;
+  else if (key == "radius") list = &opt.sweep.radius;
+  else if (key == "aoi") list = &opt.sweep.aoi;
+  if (list != NULL)
+  {
+    return parseList(value, *list);
+  }
+  if (key == "trials")
+  {
+    opt.base.num_trials = atoi(value.c_str());
+    return opt.base.num_trials > 0;
+  }
+  if (key == "msv")
+  {
+    opt.base.msv = atoi(value.c_str());
+    return opt.base.msv > 0;
+  }
+  if (key == "seed")
+  {
+    opt.base.seed = strtoull(value.c_str(), NULL, 10);
+    opt.seeded = true;
+    return true;
+  }
+  if (key == "offline-threads")
+  {
+    opt.base.offline_threads = atoi(value.c_str());
+    return opt.base.offline_threads > 0;
+  }
+  if (key == "shard") //Given as "i/N"
+  {
+    int index, count;
+    char tail;
+    if (sscanf(value.c_str(), "%d/%d%c", &index, &count, &tail) != 2 ||
+        count < 1 || index < 0 || index >= count)
+    {
+      return false;
+    }
+    opt.shard_index = index;
+    opt.shard_count = count;
+    return true;
+  }
+  if (key == "shards")
+  {
+    opt.shard_count = atoi(value.c_str());
+    return opt.shard_count > 0;
+  }
+  if (key == "shard-dir")
+  {
+    opt.shard_dir = value;
+    return true;
+  }
+  if (key == "workers")
+  {
+    opt.workers = atoi(value.c_str());
+    return opt.workers > 0;
+  }
+  if (key == "ci-width") //Given in percentage points
+  {
+    opt.base.ci_width = static_cast<float>(atof(value.c_str())/100);
+    return opt.base.ci_width > 0;
+  }
+  if (key == "max-trials")
+  {
+    opt.base.max_trials = atoi(value.c_str());
+    return opt.base.max_trials > 0;
+  }
+  if (key == "policy")
+  {
+    opt.base.policy = findPolicy(value);
+    return opt.base.policy != NULL;
+  }
+  if (key == "mix")
+  {
+    return parseMix(value, opt.base.mix);
+  }
+  if (key == "checkpoint")
+  {
+    opt.base.checkpoint_dir = value;
+    return !value.empty();
+  }
+  if (key == "checkpoint-every") //Given in seconds
+  {
+    opt.base.checkpoint_every = atof(value.c_str());
+    return opt.base.checkpoint_every > 0;
+  }
+  if (key == "batch-window")
+  {
+    opt.base.batch_window = atoi(value.c_str());
+    return opt.base.batch_window >= 0;
+  }
+  if (key == "threads")
+  {
+    opt.num_threads = atoi(value.c_str());
+    return true;
+  }
+  if (key == "stream")
+  {
+    opt.stream_count = strtoll(value.c_str(), NULL, 10);
+    return opt.stream_count > 0;
+  }
+  if (key == "input")
+  {
+    opt.stream_input = value;
+    return !value.empty();
+  }
+  if (key == "report")
+  {
+    opt.report_every = strtoll(value.c_str(), NULL, 10);
+    return opt.report_every > 0;
+  }
+  if (key == "scenario")
+  {
+    opt.scenario_path = value;
+    return !value.empty();
+  }
+  if (key == "save-scenario")
+  {
+    opt.save_path = value;
+    return !value.empty();
+  }
+  if (key == "health")
+  {
+    opt.health_path = value;
+    return !value.empty();
+  }
+  if (key == "format")
+  {
+    opt.json = (value == "json");
+    return value == "json" || value == "csv";
+  }
+  return false;
+}
+
+//CONFIGURATION FILE FUNCTION
+//Description: Reads settings from a file with one "name = value" pair per
+//line. Blank lines and lines starting with '#' are skipped. Returns false
+//if the file can't be read or holds an invalid setting.
+bool readConfig(const char* path, RunOptions & opt)
+{
+  ifstream in(path);
+  if (!in)
+  {
+    cerr << "Could not open configuration file " << path << endl;
+    return false;
+  }
+  string line;
+  while (getline(in, line))
+  {
+    size_t eq = line.find('=');
+    size_t first = line.find_first_not_of(" \t");
+    if (first == string::npos || line[first] == '#')
+    {
+      continue;
+    }
+    if (eq == string::npos)
+    {
+      cerr << "Bad configuration line: " << line << endl;
+      return false;
+    }
+    string key = line.substr(0, eq);
+    string value = line.substr(eq + 1);
+    key.erase(0, key.find_first_not_of(" \t"));
+    key.erase(key.find_last_not_of(" \t\r") + 1);
+    value.erase(0, value.find_first_not_of(" \t"));
+    value.erase(value.find_last_not_of(" \t\r") + 1);
+    if (!applyOption(key, value, opt))
+    {
+      cerr << "Bad configuration setting: " << line << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//POINT COUNTING FUNCTION
+//Description: Returns the number of combinations of the swept values.
+int countPoints(const SweepSpec & sw)
+{
+  return static_cast<int>(sw.aoi.size()*sw.sensors.size()*
+                          sw.missions.size()*sw.duration.size()*
+                          sw.radius.size()*sw.req_sens.size());
+}
+
+//POINT FUNCTION
+//Description: Sets up combination p of the swept values. The AoI changes
+//slowest since changing it means generating new layouts, then the number
+//of sensors, missions, duration and radius, and the sensors required
+//per mission fastest.
+void setPoint(const SweepSpec & sw, int p, TrialSetup & setup)
+{
+  const vector<double>* lists[6] = //Innermost first
+    {&sw.req_sens, &sw.radius, &sw.duration, &sw.missions, &sw.sensors,
+     &sw.aoi};
+  double value[6]; //Value of each list at point p
+  for (int l = 0; l < 6; l++)
+  {
+    int size = static_cast<int>(lists[l]->size());
+    value[l] = (*lists[l])[p%size];
+    p /= size;
+  }
+  if (setup.scenario_file == NULL) //A scenario file sets its own AoI
+  {
+    setup.aoi_w = static_cast<int>(value[5]);
+    setup.aoi_h = static_cast<int>(value[5]);
+  }
+  setup.num_sensors = static_cast<int>(value[4]);
+  setup.num_missions = static_cast<int>(value[3]);
+  setup.duration = static_cast<int>(value[2]);
+  setup.radius = static_cast<float>(value[1]);
+  setup.req_sens = static_cast<int>(value[0]);
+  return;
+}
+
+//SWEEP HEADER FUNCTION
+//Description: Writes the CSV header of a sweep. JSON rows have none.
+void writeSweepHeader(const RunOptions & opt, ostream & out)
+{
+  const TrialSetup & setup = opt.base;
+  if (opt.json)
+  {
+    return;
+  }
+  out << "duration,sensors,req_sens,missions,radius,aoi,trials,"
+      << "random_sat,online_sat,offline_sat,"
+      << "random_low_energy,online_low_energy,offline_low_energy";
+  if (setup.batch_window > 0)
+  {
+    out << ",batch_sat,batch_low_energy";
+  }
+  if (setup.policy != NULL)
+  {
+    out << ",policy_sat,policy_low_energy";
+  }
+  for (int k = 0; k < NUM_METRICS && setup.ci_width > 0; k++)
+  {
+    if (TrialStats::measured(setup, static_cast<Metric>(k)))
+    {
+      out << "," << METRIC_NAMES[k] << "_ci";
+    }
+  }
+  out << endl;
+  return;
+}
+
+//SWEEP ROW FUNCTION
+//Description: Writes the averaged results of one sweep point.
+void writeSweepRow(const RunOptions & opt, const TrialSetup & setup,
+                   const RunSummary & sum, const size_t trials,
+                   ostream & out)
+{
+  if (opt.json)
+  {
+    out << "{\"duration\":" << setup.duration
+        << ",\"sensors\":" << setup.num_sensors
+        << ",\"req_sens\":" << setup.req_sens
+        << ",\"missions\":" << setup.num_missions
+        << ",\"radius\":" << setup.radius
+        << ",\"aoi\":" << setup.aoi_w
+        << ",\"trials\":" << trials
+        << ",\"random_sat\":" << sum.random_sr*100
+        << ",\"online_sat\":" << sum.online_sr*100
+        << ",\"offline_sat\":" << sum.offline_sr*100
+        << ",\"random_low_energy\":" << sum.random_lep*100
+        << ",\"online_low_energy\":" << sum.online_lep*100
+        << ",\"offline_low_energy\":" << sum.offline_lep*100;
+    if (setup.batch_window > 0)
+    {
+      out << ",\"batch_sat\":" << sum.batch_sr*100
+          << ",\"batch_low_energy\":" << sum.batch_lep*100;
+    }
+    if (setup.policy != NULL)
+    {
+      out << ",\"policy\":\"" << setup.policy->name << "\""
+          << ",\"policy_sat\":" << sum.policy_sr*100
+          << ",\"policy_low_energy\":" << sum.policy_lep*100;
+    }
+    for (int k = 0; k < NUM_METRICS && setup.ci_width > 0; k++)
+    {
+      if (TrialStats::measured(setup, static_cast<Metric>(k)))
+      {
+        out << ",\"" << METRIC_NAMES[k] << "_ci\":"
+            << sum.half_width[k]*100;
+      }
+    }
+    out << "}" << endl;
+  }
+  else
+  {
+    out << setup.duration << "," << setup.num_sensors << ","
+        << setup.req_sens << "," << setup.num_missions << ","
+        << setup.radius << "," << setup.aoi_w << ","
+        << trials << ","
+        << sum.random_sr*100 << "," << sum.online_sr*100 << ","
+        << sum.offline_sr*100 << "," << sum.random_lep*100 << ","
+        << sum.online_lep*100 << "," << sum.offline_lep*100;
+    if (setup.batch_window > 0)
+    {
+      out << "," << sum.batch_sr*100 << "," << sum.batch_lep*100;
+    }
+    if (setup.policy != NULL)
+    {
+      out << "," << sum.policy_sr*100 << "," << sum.policy_lep*100;
+    }
+    for (int k = 0; k < NUM_METRICS && setup.ci_width > 0; k++)
+    {
+      if (TrialStats::measured(setup, static_cast<Metric>(k)))
+      {
+        out << "," << sum.half_width[k]*100;
+      }
+    }
+    out << endl;
+  }
+  return;
+}
+
+//SWEEP FUNCTION
+//Description: Runs every combination of the swept values and writes one
+//row per combination to out as soon as it finishes. Points are run in
+//setPoint's order, so every parameter but the AoI reuses the layouts
+//already held by each trial's Scenario.
+void runSweep(const RunOptions & opt, ostream & out)
+{
+  vector<Scenario> scenarios; //Layouts, kept across sweep points
+  vector<TrialResult> results; //Results of every trial of a point
+  RunSummary sum;
+  TrialSetup setup = opt.base;
+  writeSweepHeader(opt, out);
+  int num_points = countPoints(opt.sweep);
+  for (int p = 0; p < num_points; p++)
+  {
+    setPoint(opt.sweep, p, setup);
+    runTrials(setup, opt.num_threads, scenarios, results);
+    summarize(setup, results, sum);
+    writeSweepRow(opt, setup, sum, results.size(), out);
+  }
+  return;
+}
+
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////SHARD_MODE//////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//A sharded sweep splits the trials of every sweep point between N shards,
+//which may run as separate processes on separate machines. Trial t of
+//point p belongs to shard (p*trials + t) mod N, so each shard gets a
+//spread of small and large points. A shard writes the raw counts of its
+//trials to a partial file, and merging the partial files of all N shards
+//gives exactly the rows a single process would have written.
+//
+//A partial file is text: a "snms-partial VERSION" line, a "key" line
+//listing every setting that affects the results, a "shard I N" line, one
+//"r POINT TRIAL" line per trial followed by the counts in COUNT_FIELDS,
+//and a closing "end" line.
+
+const int PARTIAL_VERSION = 1; //Version written to partial files
+
+//SWEEP KEY FUNCTION
+//Description: Returns every setting that affects a sweep's results, so
+//partial files from differently configured runs are never merged.
+string sweepKey(const RunOptions & opt)
+{
+  const SweepSpec & sw = opt.sweep;
+  const char* names[6] = {"duration", "sensors", "req", "missions",
+                          "radius", "aoi"};
+  const vector<double>* lists[6] =
+    {&sw.duration, &sw.sensors, &sw.req_sens, &sw.missions, &sw.radius,
+     &sw.aoi};
+  ostringstream key;
+  key.precision(17);
+  key << "seed=" << opt.base.seed << ";trials=" << opt.base.num_trials
+      << ";msv=" << opt.base.msv << ";batch=" << opt.base.batch_window
+      << ";policy=" << (opt.base.policy ? opt.base.policy->name : "none")
+      << ";scenario=" << opt.scenario_path << ";mix=";
+  for (size_t c = 0; c < opt.base.mix.size(); c++)
+  {
+    const MissionClass & type = opt.base.mix[c];
+    key << (c > 0 ? "," : "") << type.duration << ":" << type.radius << ":"
+        << type.req << ":" << type.weight;
+  }
+  for (int l = 0; l < 6; l++)
+  {
+    key << ";" << names[l] << "=";
+    for (size_t v = 0; v < lists[l]->size(); v++)
+    {
+      key << (v > 0 ? "," : "") << (*lists[l])[v];
+    }
+  }
+  return key.str();
+}
+
+//SHARD FUNCTION
+//Description: Runs the trials of one shard and writes its partial file
+//to out. Returns false if the file couldn't be written.
+bool runShard(const RunOptions & opt, const int shard, ostream & out)
+{
+  int count = opt.shard_count; //Number of shards
+  int num_trials = opt.base.num_trials; //Trials of every point
+  vector<Scenario> scenarios; //Layouts, kept across sweep points
+  vector<TrialResult> results; //Results of the shard's trials of a point
+  vector<int> trials; //The shard's trials of a point
+  TrialSetup setup = opt.base;
+  out << "snms-partial " << PARTIAL_VERSION << endl;
+  out << "key " << sweepKey(opt) << endl;
+  out << "shard " << shard << " " << count << endl;
+  int num_points = countPoints(opt.sweep);
+  for (int p = 0; p < num_points; p++)
+  {
+    trials.clear();
+    for (int t = 0; t < num_trials; t++)
+    {
+      if ((static_cast<long long>(p)*num_trials + t)%count == shard)
+      {
+        trials.push_back(t);
+      }
+    }
+    if (trials.empty())
+    {
+      continue;
+    }
+    setPoint(opt.sweep, p, setup);
+    runTrialList(setup, opt.num_threads, trials, scenarios, results);
+    for (size_t k = 0; k < trials.size(); k++)
+    {
+      out << "r " << p << " " << trials[k];
+      for (int f = 0; f < NUM_COUNT_FIELDS; f++)
+      {
+        out << " " << results[trials[k]].*COUNT_FIELDS[f];
+      }
+      out << endl;
+    }
+  }
+  out << "end" << endl;
+  return static_cast<bool>(out);
+}
+
+//SHARD WORKER FUNCTION
+//Description: Claims and runs shards in opt.shard_dir until none are
+//left. A shard is claimed by creating its claim file, which fails if
+//another worker created it first, so any number of workers on machines
+//sharing the directory take the next free shard as they go idle. Each
+//partial file is written under a temporary name and then renamed, so a
+//partial file that exists is complete. Deleting a claim file lets a shard
+//whose worker died be claimed again.
+bool runShardWorker(const RunOptions & opt)
+{
+  for (int j = 0; j < opt.shard_count; j++)
+  {
+    ostringstream base;
+    base << opt.shard_dir << "/shard-" << j;
+    string claim = base.str() + ".claim";
+    int fd = open(claim.c_str(), O_CREAT | O_EXCL | O_WRONLY, 0644);
+    if (fd < 0)
+    {
+      if (errno == EEXIST) //Another worker has it
+      {
+        continue;
+      }
+      cerr << "Could not create " << claim << ": " << strerror(errno)
+           << endl;
+      return false;
+    }
+    close(fd);
+    string temp = base.str() + ".tmp";
+    string part = base.str() + ".part";
+    ofstream out(temp.c_str());
+    bool written = runShard(opt, j, out);
+    out.close();
+    if (!written || !out || rename(temp.c_str(), part.c_str()) != 0)
+    {
+      cerr << "Could not write " << part << endl;
+      return false;
+    }
+  }
+  return true;
+}
+
+//SHARD WORKERS FUNCTION
+//Description: Runs opt.workers shard workers, this process and the rest
+//as child processes, and waits for all of them. Returns false if any of
+//them failed.
+bool runShardWorkers(const RunOptions & opt)
+{
+  vector<pid_t> children;
+  for (int w = 1; w < opt.workers; w++)
+  {
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+      _exit(runShardWorker(opt) ? 0 : 1);
+    }
+    if (pid < 0)
+    {
+      cerr << "Could not start a worker: " << strerror(errno) << endl;
+      break;
+    }
+    children.push_back(pid);
+  }
+  bool ok = runShardWorker(opt);
+  for (size_t c = 0; c < children.size(); c++)
+  {
+    int status = 0;
+    waitpid(children[c], &status, 0);
+    ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+  }
+  return ok;
+}
+
+//MERGE FUNCTION
+//Description: Reads the partial files of every shard of a sweep and
+//writes the same rows runSweep would have. The sweep's settings must be
+//the ones the shards were run with. If no files are listed, the partial
+//files of opt.shard_count shards in opt.shard_dir are read. Returns false
+//if a file doesn't match the settings, or any trial is missing or given
+//twice.
+bool mergeShards(const RunOptions & opt, ostream & out)
+{
+  vector<string> paths = opt.merge_paths;
+  for (int j = 0; opt.merge_paths.empty() && j < opt.shard_count; j++)
+  {
+    ostringstream part;
+    part << opt.shard_dir << "/shard-" << j << ".part";
+    paths.push_back(part.str());
+  }
+  if (paths.empty())
+  {
+    cerr << "--merge needs partial files, or --shard-dir and --shards"
+         << endl;
+    return false;
+  }
+  int num_points = countPoints(opt.sweep);
+  int num_trials = opt.base.num_trials;
+  string key = "key " + sweepKey(opt);
+  vector<vector<TrialResult> > results(num_points,
+                                       vector<TrialResult>(num_trials));
+  vector<char> seen(static_cast<size_t>(num_points)*num_trials, 0);
+  int count = 0; //Number of shards, from the first file
+  for (size_t f = 0; f < paths.size(); f++)
+  {
+    ifstream in(paths[f].c_str());
+    string line;
+    int version = 0, shard = 0, shards = 0;
+    if (!getline(in, line) ||
+        sscanf(line.c_str(), "snms-partial %d", &version) != 1 ||
+        version != PARTIAL_VERSION)
+    {
+      cerr << paths[f] << " is not a partial file" << endl;
+      return false;
+    }
+    if (!getline(in, line) || line != key)
+    {
+      cerr << paths[f] << " was run with different settings" << endl;
+      return false;
+    }
+    if (!getline(in, line) ||
+        sscanf(line.c_str(), "shard %d %d", &shard, &shards) != 2 ||
+        (count != 0 && shards != count))
+    {
+      cerr << paths[f] << " has a bad shard line" << endl;
+      return false;
+    }
+    count = shards;
+    bool ended = false; //Set by the closing line
+    while (getline(in, line))
+    {
+      if (line == "end")
+      {
+        ended = true;
+        break;
+      }
+      istringstream row(line);
+      string tag;
+      int p = -1, t = -1;
+      row >> tag >> p >> t;
+      if (tag != "r" || p < 0 || p >= num_points || t < 0 ||
+          t >= num_trials)
+      {
+        cerr << paths[f] << " has a bad line: " << line << endl;
+        return false;
+      }
+      if (seen[static_cast<size_t>(p)*num_trials + t]++)
+      {
+        cerr << "Trial " << t << " of point " << p << " is given twice"
+             << endl;
+        return false;
+      }
+      for (int c = 0; c < NUM_COUNT_FIELDS; c++)
+      {
+        row >> results[p][t].*COUNT_FIELDS[c];
+      }
+      if (!row)
+      {
+        cerr << paths[f] << " has a bad line: " << line << endl;
+        return false;
+      }
+    }
+    if (!ended)
+    {
+      cerr << paths[f] << " is incomplete" << endl;
+      return false;
+    }
+  }
+  for (size_t u = 0; u < seen.size(); u++)
+  {
+    if (!seen[u])
+    {
+      cerr << "Trial " << u%num_trials << " of point " << u/num_trials
+           << " is missing" << endl;
+      return false;
+    }
+  }
+  TrialSetup setup = opt.base;
+  RunSummary sum;
+  writeSweepHeader(opt, out);
+  for (int p = 0; p < num_points; p++)
+  {
+    setPoint(opt.sweep, p, setup);
+    summarize(setup, results[p], sum);
+    writeSweepRow(opt, setup, sum, results[p].size(), out);
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////
+/////////////////////////////STREAM_MODE//////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//A stream runs the Random and Online Algorithms side by side over missions
+//that are generated, or read, one at a time, rather than held in a list.
+//Missions must arrive in order of start time. Every so often each sensor
+//forgets the schedules that have already ended, so memory stays
+//proportional to the sensors and the missions still running, however long
+//the stream is. Times are kept relative to an origin that is moved forward
+//before they can overflow.
+
+//This object produces the missions of a stream. Generated missions follow
+//the same sequence as trial 0 of a regular run with the same seed. Read
+//missions come one per line as "start end x y", with integer times.
+class MissionSource
+{
+  private:
+    RandGen ms_rng; //Mission generation stream
+    istream* ms_in; //Input the missions are read from, or NULL
+    const ScenarioFile* ms_file; //Scenario the missions are taken from
+    int ms_msv; //Maximum variance in start time
+    int ms_duration; //Duration of generated missions
+    int ms_aoi_w; //AoI width generated missions are placed in
+    int ms_aoi_h; //AoI height generated missions are placed in
+    long long ms_left; //Missions left to produce, or -1 for no limit
+    long long ms_clock; //Start time of the last mission produced
+    long long ms_line; //Line of the input last read
+    long long ms_next; //Next mission of the scenario file
+
+  public:
+
+    //CONSTRUCTOR
+    //Description: Produces up to count missions, or, if count is 0, every
+    //mission in the input or the setup's scenario file.
+    MissionSource(const TrialSetup & setup, const long long count,
+                  istream* in)
+      : ms_rng(setup.seed, 0, RandGen::MISSION_STREAM)
+    {
+      ms_in = in;
+      ms_file = setup.scenario_file;
+      ms_next = 0;
+      ms_msv = setup.msv;
+      ms_duration = setup.duration;
+      ms_aoi_w = setup.aoi_w;
+      ms_aoi_h = setup.aoi_h;
+      ms_left = count > 0 ? count : -1;
+      ms_clock = 0;
+      ms_line = 0;
+    }
+
+    //NEXT FUNCTION
+    //Description: Produces the next mission. Returns false when the
+    //stream has ended, or if a line can't be read, in which case bad is
+    //set.
+    bool next(long long & start, long long & end, float & ex, float & ey,
+              bool & bad)
+    {
+      bad = false;
+      if (ms_left == 0)
+      {
+        return false;
+      }
+      if (ms_file != NULL)
+      {
+        if (ms_next == ms_file->getMISSIONCOUNT())
+        {
+          return false;
+        }
+        const MissionRecord & r = ms_file->getMISSION(ms_next++);
+        start = r.start;
+        end = r.end;
+        ex = r.ex;
+        ey = r.ey;
+        if (end < start || end - start > INT_MAX/2 || start < ms_clock)
+        {
+          cerr << "Bad or out of order mission " << ms_next
+               << " in the scenario file" << endl;
+          bad = true;
+          return false;
+        }
+        ms_clock = start;
+      }
+      else if (ms_in == NULL)
+      {
+        ms_clock += (ms_rng.next()%ms_msv);
+        start = ms_clock;
+        end = start + ms_duration;
+        place(ms_aoi_w, ex, ms_rng);
+        place(ms_aoi_h, ey, ms_rng);
+      }
+      else
+      {
+        string line;
+        do
+        {
+          if (!getline(*ms_in, line))
+          {
+            return false;
+          }
+          ms_line++;
+        } while (line.find_first_not_of(" \t\r") == string::npos ||
+                 line[line.find_first_not_of(" \t\r")] == '#');
+        int used = 0; //Characters of the line parsed
+        if (sscanf(line.c_str(), "%lld %lld %f %f%n", &start, &end, &ex,
+                   &ey, &used) != 4 || !endsAt(line, used) || end < start ||
+            end - start > INT_MAX/2 || start < ms_clock)
+        {
+          cerr << "Bad or out of order mission on line " << ms_line
+               << ": " << line << endl;
+          bad = true;
+          return false;
+        }
+        ms_clock = start;
+      }
+      if (ms_left > 0)
+      {
+        ms_left--;
+      }
+      return true;
+    }
+
+};
+
+//These are the missions a stream passes between threads, and the running
+//results a stage reports.
+struct StreamMission
+{
+  long long start; //Stream time the mission starts
+  long long end; //Stream time the mission ends
+  float ex; //Epicenter of the mission
+  float ey;
+};
+
+struct StreamReport
+{
+  long long count; //Missions processed
+  long long satis; //Missions satisfied
+  int les; //Low-energy sensors
+};
+
+//This object is a bounded ring that one thread pushes items into and one
+//other thread pops them from, without locks. Each side only writes its
+//own index, and publishes a whole batch of items with a single store.
+//The capacity must be a power of two.
+template <class T>
+class SpscRing
+{
+  private:
+    vector<T> r_slot; //Items, indexed by position mod capacity
+    size_t r_mask; //Capacity minus one
+    alignas(64) atomic<size_t> r_head; //Next position to pop, by the reader
+    alignas(64) atomic<size_t> r_tail; //Next position to push, by the writer
+    atomic<bool> r_closed; //Set by the writer once it has pushed its last
+
+  public:
+
+    //CONSTRUCTOR
+    explicit SpscRing(const size_t capacity)
+      : r_slot(capacity), r_mask(capacity - 1), r_head(0), r_tail(0),
+        r_closed(false) {}
+
+    //PUSH FUNCTION
+    //Description: Pushes as many of count items as there is room for, and
+    //returns how many that was.
+    int push(const T* items, const int count)
+    {
+      size_t tail = r_tail.load(memory_order_relaxed);
+      size_t room = r_slot.size() - (tail - r_head.load(memory_order_acquire));
+      int n = static_cast<int>(min(room, static_cast<size_t>(count)));
+      for (int k = 0; k < n; k++)
+      {
+        r_slot[(tail + k) & r_mask] = items[k];
+      }
+      r_tail.store(tail + n, memory_order_release);
+      return n;
+    }
+
+    //POP FUNCTION
+    //Description: Pops up to max_count items, and returns how many.
+    int pop(T* items, const int max_count)
+    {
+      size_t head = r_head.load(memory_order_relaxed);
+      size_t ready = r_tail.load(memory_order_acquire) - head;
+      int n = static_cast<int>(min(ready, static_cast<size_t>(max_count)));
+      for (int k = 0; k < n; k++)
+      {
+        items[k] = r_slot[(head + k) & r_mask];
+      }
+      r_head.store(head + n, memory_order_release);
+      return n;
+    }
+
+    //CLOSE FUNCTIONS
+    //Description: The writer closes the ring after its last push. Items
+    //pushed before the close can still be popped after it is seen.
+    void close(){ r_closed.store(true, memory_order_release); }
+    bool isClosed()const{ return r_closed.load(memory_order_acquire); }
+};
+
+//BACKOFF FUNCTION
+//Description: Waits a little while a ring is full or empty. The first
+//waits just yield, and later ones sleep so an idle thread doesn't hold a
+//core.
+void backoff(int & spins)
+{
+  if (spins++ < 64)
+  {
+    this_thread::yield();
+  }
+  else
+  {
+    this_thread::sleep_for(chrono::microseconds(50));
+  }
+  return;
+}
+
+//PUSH ALL FUNCTION
+//Description: Pushes every item into a ring, waiting for room as needed.
+template <class T>
+void pushAll(SpscRing<T> & ring, const T* items, const int count)
+{
+  int pushed = 0;
+  int spins = 0;
+  while (pushed < count)
+  {
+    int n = ring.push(items + pushed, count - pushed);
+    pushed += n;
+    if (n == 0)
+    {
+      backoff(spins);
+    }
+    else
+    {
+      spins = 0;
+    }
+  }
+  return;
+}
+
+//POP SOME FUNCTION
+//Description: Pops up to max_count items, waiting until there is at
+//least one. Returns 0 only once the ring is closed and empty.
+template <class T>
+int popSome(SpscRing<T> & ring, T* items, const int max_count)
+{
+  int spins = 0;
+  while (true)
+  {
+    int n = ring.pop(items, max_count);
+    if (n > 0)
+    {
+      return n;
+    }
+    if (ring.isClosed()) //Anything pushed before the close is visible now
+    {
+      return ring.pop(items, max_count);
+    }
+    backoff(spins);
+  }
+}
+
+//This object runs one algorithm of a stream on its own copy of the
+//network. Every stage sees the same missions in the same order, so a
+//stage can run on its own thread and still get the results it would get
+//alongside the others.
+class StreamStage
+{
+  private:
+    Network ss_net; //The stage's copy of the network
+    SweepLineScheduler ss_sweep; //Runs the Online Algorithm, if a sweep
+    RandGen ss_rng; //Picks of the Random Algorithm
+    bool ss_random; //If true, runs the Random Algorithm
+    bool ss_use_sweep; //If true, runs the Online Algorithm as a sweep
+    int ss_req; //Sensors required per mission
+    float ss_radius; //Range of every mission
+    int ss_duration; //Energy below which a sensor counts as low energy
+    long long ss_expire_every; //Missions between dropping ended schedules
+    long long ss_origin; //Stream time of local time 0
+    long long ss_count; //Missions processed
+    long long ss_satis; //Missions satisfied
+
+  public:
+
+    //CONSTRUCTOR
+    //Description: Builds the stage's network from the passed sensors.
+    StreamStage(const TrialSetup & setup, const vector<Sensor> & sensors,
+                const bool random)
+      : ss_rng(setup.seed, 0, RandGen::RANDOM_STREAM)
+    {
+      ss_random = random;
+      ss_use_sweep = !random && setup.sweep_line;
+      ss_req = setup.req_sens;
+      ss_radius = setup.radius;
+      ss_duration = setup.duration;
+      //Ended schedules are dropped once per this many missions, which
+      //costs about one sensor visit per mission.
+      ss_expire_every = setup.num_sensors > 4096 ? setup.num_sensors : 4096;
+      ss_origin = 0;
+      ss_count = 0;
+      ss_satis = 0;
+      ss_net.setSpatialIndex(setup.use_index);
+      ss_net.setGeometry(setup.aoi_w, setup.aoi_h);
+      ss_net.addSensors(sensors, setup.num_sensors);
+      if (ss_use_sweep)
+      {
+        ss_sweep.reset(ss_net);
+      }
+    }
+
+    //PROCESS FUNCTION
+    //Description: Attempts the next mission of the stream.
+    void process(const StreamMission & m)
+    {
+      const long long rebase_at = 1 << 30; //Local time that moves the origin
+      if (m.start - ss_origin >= rebase_at) //Moves the origin to m
+      {
+        int delta = static_cast<int>(m.start - ss_origin);
+        ss_net.expireSchedules(delta);
+        ss_net.shiftTime(delta);
+        if (ss_use_sweep)
+        {
+          ss_sweep.shiftTime(delta);
+        }
+        ss_origin = m.start;
+      }
+      Mission task(static_cast<int>(m.start - ss_origin),
+                   static_cast<int>(m.end - m.start), m.ex, m.ey,
+                   ss_radius);
+      if (ss_use_sweep)
+      {
+        ss_satis += ss_sweep.process(task, ss_req) ? 1 : 0;
+      }
+      else
+      {
+        int before = ss_net.getMISSIONSATIS();
+        if (ss_random)
+        {
+          ss_net.randomAssign(task, ss_req, ss_rng);
+        }
+        else
+        {
+          ss_net.missionAssign(task, ss_req);
+        }
+        ss_satis += ss_net.getMISSIONSATIS() - before;
+      }
+      ss_count++;
+      if (ss_count % ss_expire_every == 0)
+      {
+        ss_net.expireSchedules(task.getSTART());
+      }
+      return;
+    }
+
+    //REPORT FUNCTION
+    //Description: Returns the stage's running results.
+    StreamReport report()const
+    {
+      StreamReport r;
+      r.count = ss_count;
+      r.satis = ss_satis;
+      r.les = ss_use_sweep ? ss_sweep.calcLES(ss_duration)
+                           : ss_net.calcLES(ss_duration);
+      return r;
+    }
+
+    long long getCOUNT()const{ return ss_count; }
+};
+
+//STREAM ROW FUNCTION
+//Description: Writes one row of a stream's running results.
+void writeStreamRow(const StreamReport & random, const StreamReport & online,
+                    const int num_sensors, ostream & out)
+{
+  out << random.count << "," << random.satis*100.0/random.count << ","
+      << online.satis*100.0/online.count << ","
+      << random.les*100.0/num_sensors << ","
+      << online.les*100.0/num_sensors << endl;
+  return;
+}
+
+//PIPELINED STREAM FUNCTION
+//Description: Runs a stream on three threads. A producer makes missions
+//and pushes them in batches into one ring per stage, and each stage runs
+//on its own thread, popping missions as they arrive, so making missions
+//overlaps with both algorithms. Stages push their running results into
+//their own report rings, which the calling thread pairs up and writes.
+//The rows are the same as a serial run's. Returns false if the input
+//can't be read.
+bool runPipeline(const RunOptions & opt, MissionSource & source,
+                 StreamStage * stages[2], ostream & out)
+{
+  const int batch_size = 256; //Missions pushed or popped at once
+  const int num_stages = 2;
+  SpscRing<StreamMission> random_in(1 << 14), online_in(1 << 14);
+  SpscRing<StreamReport> random_out(64), online_out(64);
+  SpscRing<StreamMission>* missions[2] = {&random_in, &online_in};
+  SpscRing<StreamReport>* reports[2] = {&random_out, &online_out};
+  bool bad = false;
+  thread producer([&]()
+  {
+    StreamMission batch[batch_size];
+    int n = 0;
+    bool more = true;
+    while (more)
+    {
+      StreamMission & m = batch[n];
+      more = source.next(m.start, m.end, m.ex, m.ey, bad);
+      n += more ? 1 : 0;
+      if (n == batch_size || (!more && n > 0))
+      {
+        for (int g = 0; g < num_stages; g++)
+        {
+          pushAll(*missions[g], batch, n);
+        }
+        n = 0;
+      }
+    }
+    for (int g = 0; g < num_stages; g++)
+    {
+      missions[g]->close();
+    }
+  });
+  vector<thread> consumers;
+  for (int g = 0; g < num_stages; g++)
+  {
+    consumers.push_back(thread([&, g]()
+    {
+      StreamMission batch[batch_size];
+      StreamStage & stage = *stages[g];
+      int n;
+      while ((n = popSome(*missions[g], batch, batch_size)) > 0)
+      {
+        for (int k = 0; k < n; k++)
+        {
+          stage.process(batch[k]);
+          if (stage.getCOUNT() % opt.report_every == 0)
+          {
+            StreamReport r = stage.report();
+            pushAll(*reports[g], &r, 1);
+          }
+        }
+      }
+      if (stage.getCOUNT() % opt.report_every != 0)
+      {
+        StreamReport r = stage.report();
+        pushAll(*reports[g], &r, 1);
+      }
+      reports[g]->close();
+      SNMS_FLUSH();
+    }));
+  }
+  StreamReport row[2]; //Matching reports of the two stages
+  while (popSome(*reports[0], &row[0], 1) > 0 &&
+         popSome(*reports[1], &row[1], 1) > 0)
+  {
+    writeStreamRow(row[0], row[1], opt.base.num_sensors, out);
+  }
+  producer.join();
+  for (int g = 0; g < num_stages; g++)
+  {
+    consumers[g].join();
+  }
+  return !bad;
+}
+
+//STREAM FUNCTION
+//Description: Streams missions through the Random and Online Algorithms,
+//each on its own copy of the network, writing a row of running results
+//every opt.report_every missions and once more at the end. With
+//opt.pipeline the stages run on their own threads. Returns false if the
+//input can't be read.
+bool runStream(const RunOptions & opt, ostream & out)
+{
+  const TrialSetup & setup = opt.base;
+  ifstream file; //Input file, if missions are read from one
+  istream* in = NULL; //Input the missions come from, if not generated
+  if (!opt.stream_input.empty())
+  {
+    if (opt.stream_input == "-")
+    {
+      in = &cin;
+    }
+    else
+    {
+      file.open(opt.stream_input.c_str());
+      if (!file)
+      {
+        cerr << "Could not open mission input " << opt.stream_input << endl;
+        return false;
+      }
+      in = &file;
+    }
+  }
+  RandGen sensor_rng(setup.seed, 0, RandGen::SENSOR_STREAM);
+  vector<Sensor> sensors; //Layout shared by both networks
+  sensors.reserve(setup.num_sensors);
+  for (int i = 0; i < setup.num_sensors; i++)
+  {
+    if (setup.scenario_file != NULL)
+    {
+      const SensorRecord & r = setup.scenario_file->getSENSOR(i);
+      sensors.emplace_back(r.x, r.y, r.energy);
+    }
+    else
+    {
+      sensors.emplace_back(sensor_rng, setup.aoi_w, setup.aoi_h);
+    }
+  }
+  StreamStage random(setup, sensors, true); //Runs the Random Algorithm
+  StreamStage online(setup, sensors, false); //Runs the Online Algorithm
+  sensors.clear();
+  MissionSource source(setup, opt.stream_count, in);
+  out << "missions,random_sat,online_sat,random_low_energy,"
+      << "online_low_energy" << endl;
+  if (opt.pipeline)
+  {
+    StreamStage* stages[2] = {&random, &online};
+    return runPipeline(opt, source, stages, out);
+  }
+  StreamMission m;
+  bool bad = false;
+  while (source.next(m.start, m.end, m.ex, m.ey, bad))
+  {
+    random.process(m);
+    online.process(m);
+    if (random.getCOUNT() % opt.report_every == 0)
+    {
+      writeStreamRow(random.report(), online.report(), setup.num_sensors,
+                     out);
+    }
+  }
+  if (random.getCOUNT() % opt.report_every != 0)
+  {
+    writeStreamRow(random.report(), online.report(), setup.num_sensors,
+                   out);
+  }
+  return !bad;
+}
+
+#ifdef SNMS_BENCHMARK
+//////////////////////////////////////////////////////////////////////////
+//////////////////////////////BENCHMARKS//////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+//When built with SNMS_BENCHMARK defined ("make bench"), the program times
+//the scheduling hot paths instead of running trials. Each benchmark runs
+//over a grid of sensor counts, mission counts and sensors required per
+//mission, and reports the time per operation, the missions handled per
+//second and the process's peak resident memory so far. Results can be
+//saved as a baseline, and later runs compared against it to flag any
+//benchmark that got slower by more than a tolerance.
+
+//These are the measurements of one benchmark at one grid point.
+struct BenchResult
+{
+  string name; //Name of the benchmark
+  int sensors; //Number of sensors
+  int missions; //Number of missions
+  int req_sens; //Sensors required per mission
+  double ns_per_op; //Average time of one operation
+  double missions_per_sec; //Missions handled per second
+  long peak_rss_kb; //Peak resident memory of the process
+};
+
+//CLOCK FUNCTION
+//Description: Returns a monotonic time in nanoseconds.
+double nowNS()
+{
+  return static_cast<double>(chrono::duration_cast<chrono::nanoseconds>(
+           chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+//PEAK MEMORY FUNCTION
+//Description: Returns the peak resident memory of the process in KiB.
+long peakRSS()
+{
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
+
+//BENCHMARK KEY FUNCTION
+//Description: Names a benchmark at a grid point, for baseline files.
+string benchKey(const BenchResult & r)
+{
+  char key[128];
+  snprintf(key, sizeof(key), "%s/%d/%d/%d", r.name.c_str(), r.sensors,
+           r.missions, r.req_sens);
+  return key;
+}
+
+//RECORD FUNCTION
+//Description: Stores and prints one benchmark result. ops is the number
+//of operations timed and missions the number of missions they covered.
+void recordBench(vector<BenchResult> & all, const string & name,
+                 const TrialSetup & setup, const double elapsed_ns,
+                 const long ops, const long missions)
+{
+  BenchResult r;
+  r.name = name;
+  r.sensors = setup.num_sensors;
+  r.missions = setup.num_missions;
+  r.req_sens = setup.req_sens;
+  r.ns_per_op = elapsed_ns/(ops > 0 ? ops : 1);
+  r.missions_per_sec = (elapsed_ns > 0) ? missions*1e9/elapsed_ns : 0;
+  r.peak_rss_kb = peakRSS();
+  all.push_back(r);
+  printf("%-16s %8d %8d %4d %14.1f %14.0f %10.1f\n", name.c_str(),
+         r.sensors, r.missions, r.req_sens, r.ns_per_op, r.missions_per_sec,
+         r.peak_rss_kb/1024.0);
+  fflush(stdout);
+  return;
+}
+
+//BENCHMARK POINT FUNCTION
+//Description: Runs every benchmark at one grid point. The network and
+//missions are built the same way runTrial builds them.
+void benchPoint(const TrialSetup & setup, Scenario & scenario,
+                vector<BenchResult> & all)
+{
+  int m_count = setup.num_missions; //Number of missions
+  vector<Mission> List; //Missions of this point
+  Network WSN; //Network of this point
+  EligibilityGraph graph; //Sensors in range of each mission
+  OfflineScheduler offline; //Runs the Offline Algorithm
+  RandGen random_rng(setup.seed, 0, RandGen::RANDOM_STREAM);
+  double t0;
+
+  scenario.prepare(setup.seed, 0, setup.aoi_w, setup.aoi_h, setup.msv,
+                   setup.num_sensors, m_count);
+  WSN.setGeometry(setup.aoi_w, setup.aoi_h);
+  WSN.addSensors(scenario.getSENSORS(), setup.num_sensors);
+  buildMissions(setup, 0, scenario, List);
+  t0 = nowNS();
+  graph.build(WSN, List);
+  recordBench(all, "graphBuild", setup, nowNS() - t0, m_count, m_count);
+  WSN.attachGraph(&graph);
+
+  /*-----RANDOM ASSIGNMENT-----*/
+  t0 = nowNS();
+  for (int i = 0; i < m_count; i++)
+  {
+    WSN.randomAssign(List[i], setup.req_sens, random_rng);
+  }
+  recordBench(all, "randomAssign", setup, nowNS() - t0, m_count, m_count);
+
+  /*-----MISSION ASSIGNMENT-----*/
+  WSN.resetNetwork();
+  for (int i = 0; i < m_count; i++)
+  {
+    List[i].attempted = false;
+  }
+  t0 = nowNS();
+  for (int i = 0; i < m_count; i++)
+  {
+    WSN.missionAssign(List[i], setup.req_sens);
+  }
+  recordBench(all, "missionAssign", setup, nowNS() - t0, m_count, m_count);
+
+  /*-----READ-ONLY QUERIES-----*/
+  //These run against the state left by the online pass, so sensors have
+  //realistic energy levels and schedules.
+  volatile long sink = 0; //Keeps the results from being optimized away
+  t0 = nowNS();
+  for (int i = 0; i < m_count; i++)
+  {
+    sink += WSN.countSched(List[i]);
+  }
+  recordBench(all, "countSched", setup, nowNS() - t0, m_count, m_count);
+  t0 = nowNS();
+  for (int i = 0; i < m_count; i++)
+  {
+    sink += WSN.calcTE(List[i], setup.req_sens);
+  }
+  recordBench(all, "calcTE", setup, nowNS() - t0, m_count, m_count);
+  long pairs = 0; //Number of isSchedulable calls timed
+  t0 = nowNS();
+  for (int i = 0; i < m_count; i++)
+  {
+    const int* row = graph.sensorsOf(i);
+    for (int j = 0; j < graph.sensorCount(i); j++)
+    {
+      sink += WSN.isSchedulable(row[j], List[i]);
+      pairs++;
+    }
+  }
+  recordBench(all, "isSchedulable", setup, nowNS() - t0, pairs, m_count);
+
+  /*-----OFFLINE LOOP-----*/
+  WSN.resetNetwork();
+  for (int i = 0; i < m_count; i++)
+  {
+    List[i].attempted = false;
+  }
+  t0 = nowNS();
+  offline.run(WSN, List, setup.req_sens, &graph);
+  recordBench(all, "offline", setup, nowNS() - t0, m_count, m_count);
+
+  /*-----REGISTERED POLICIES-----*/
+  for (int p = 0; p < NUM_POLICIES; p++)
+  {
+    WSN.resetNetwork();
+    for (int i = 0; i < m_count; i++)
+    {
+      List[i].attempted = false;
+    }
+    RandGen policy_rng(setup.seed, 0, RandGen::POLICY_STREAM);
+    t0 = nowNS();
+    POLICY_REGISTRY[p].run(WSN, List, setup.req_sens, policy_rng, &graph);
+    recordBench(all, string("policy:") + POLICY_REGISTRY[p].name, setup,
+                nowNS() - t0, m_count, m_count);
+  }
+  return;
+}
+
+//BASELINE LOADING FUNCTION
+//Description: Reads a baseline file written by saveBaseline.
+bool loadBaseline(const char* path, map<string, double> & baseline)
+{
+  ifstream in(path);
+  if (!in)
+  {
+    cerr << "Could not open baseline file " << path << endl;
+    return false;
+  }
+  string key;
+  double ns;
+  while (in >> key >> ns)
+  {
+    baseline[key] = ns;
+  }
+  return true;
+}
+
+//BASELINE SAVING FUNCTION
+//Description: Writes one "name/sensors/missions/req ns_per_op" line per
+//benchmark result.
+bool saveBaseline(const char* path, const vector<BenchResult> & all)
+{
+  ofstream out(path);
+  if (!out)
+  {
+    cerr << "Could not write baseline file " << path << endl;
+    return false;
+  }
+  for (size_t i = 0; i < all.size(); i++)
+  {
+    out << benchKey(all[i]) << " " << all[i].ns_per_op << endl;
+  }
+  return true;
+}
+
+//BENCHMARK DRIVER FUNCTION
+//Description: Parses the benchmark options, runs the grid and compares it
+//against a baseline if one was given. Returns 2 if any benchmark
+//regressed, so scripts can detect it.
+int runBenchmarks(int argc, char* argv[])
+{
+  vector<double> sensors(1, 1000); //Sensor counts to run
+  vector<double> missions(1, 1000); //Mission counts to run
+  vector<double> req_sens(1, 10); //Sensors required per mission to run
+  sensors.push_back(10000);
+  sensors.push_back(100000);
+  bool fixed_aoi = false; //If true, the AoI doesn't grow with the network
+  double tolerance = 0.10; //Allowed slowdown before flagging a regression
+  const char* save_path = NULL; //Baseline file to write
+  const char* base_path = NULL; //Baseline file to compare against
+  TrialSetup setup;
+  setup.duration = 10;
+  setup.radius = M_RAD;
+  setup.msv = MSV;
+  setup.num_trials = 1;
+  setup.use_index = true;
+  setup.naive_offline = false;
+  setup.offline_threads = 1;
+  setup.use_graph = true;
+  setup.sweep_line = false;
+  setup.batch_window = 0;
+  setup.policy = NULL;
+  setup.ci_width = 0;
+  setup.max_trials = MAX_TEST;
+  setup.scenario_file = NULL;
+  setup.record_health = false;
+  setup.checkpoint_every = 60;
+  setup.resume = false;
+  setup.seed = 1;
+  for (int a = 1; a < argc; a++)
+  {
+    string opt = argv[a];
+    bool has_value = (a + 1 < argc);
+    if (opt == "--full") //Full grid, up to a million sensors
+    {
+      parseList("1000,10000,100000,1000000", sensors);
+      parseList("1000,10000", missions);
+      parseList("5,10,20", req_sens);
+    }
+    else if (opt == "--fixed-aoi")
+    {
+      fixed_aoi = true;
+    }
+    else if (opt == "--sensors" && has_value)
+    {
+      if (!parseList(argv[++a], sensors))
+      {
+        return 1;
+      }
+    }
+    else if (opt == "--missions" && has_value)
+    {
+      if (!parseList(argv[++a], missions))
+      {
+        return 1;
+      }
+    }
+    else if (opt == "--req" && has_value)
+    {
+      if (!parseList(argv[++a], req_sens))
+      {
+        return 1;
+      }
+    }
+    else if (opt == "--duration" && has_value)
+    {
+      setup.duration = atoi(argv[++a]);
+    }
+    else if (opt == "--mix" && has_value) //Mixed workload, as in a run
+    {
+      if (!parseMix(argv[++a], setup.mix))
+      {
+        return 1;
+      }
+    }
+    else if (opt == "--save-baseline" && has_value)
+    {
+      save_path = argv[++a];
+    }
+    else if (opt == "--baseline" && has_value)
+    {
+      base_path = argv[++a];
+    }
+    else if (opt == "--tolerance" && has_value)
+    {
+      tolerance = atof(argv[++a]);
+    }
+    else
+    {
+      cerr << "Unknown or invalid option: " << opt << endl;
+      return 1;
+    }
+  }
+
+  map<string, double> baseline; //Baseline ns/op of each benchmark
+  if (base_path != NULL && !loadBaseline(base_path, baseline))
+  {
+    return 1;
+  }
+  vector<BenchResult> all; //Every result of the run
+  printf("%-16s %8s %8s %4s %14s %14s %10s\n", "benchmark", "sensors",
+         "missions", "req", "ns/op", "missions/s", "peakRSS_MB");
+  for (size_t n = 0; n < sensors.size(); n++)
+  {
+    Scenario scenario; //Layout shared by every point with this many sensors
+    setup.num_sensors = static_cast<int>(sensors[n]);
+    //Unless told otherwise, the AoI grows with the network so that the
+    //density of sensors, and so the work per mission, stays the same as
+    //1000 sensors in the default AoI.
+    double scale = fixed_aoi ? 1.0 : sqrt(sensors[n]/1000.0);
+    setup.aoi_w = static_cast<int>(AOI_W*scale + 0.5);
+    setup.aoi_h = static_cast<int>(AOI_H*scale + 0.5);
+    for (size_t m = 0; m < missions.size(); m++)
+    for (size_t q = 0; q < req_sens.size(); q++)
+    {
+      setup.num_missions = static_cast<int>(missions[m]);
+      setup.req_sens = static_cast<int>(req_sens[q]);
+      benchPoint(setup, scenario, all);
+    }
+  }
+
+  int regressions = 0; //Benchmarks slower than the baseline allows
+  for (size_t i = 0; i < all.size() && base_path != NULL; i++)
+  {
+    map<string, double>::const_iterator it = baseline.find(benchKey(all[i]));
+    if (it != baseline.end() && all[i].ns_per_op > it->second*(1 + tolerance))
     {
-      m_mission_count = 0;
-      m_mission_satis = 0;
-      m_num = sensor_count;
-      Sensor* temp;
-      for (int i = 0; i < sensor_count; i++)
-      {
-        temp = new Sensor;
-        m_sensor.push_back(*temp);
-        delete temp;
-      }
-      temp = NULL;
+      printf("REGRESSION %s: %.1f ns/op vs baseline %.1f ns/op (+%.1f%%)\n",
+             benchKey(all[i]).c_str(), all[i].ns_per_op, it->second,
+             (all[i].ns_per_op/it->second - 1)*100);
+      regressions++;
     }
-    
-    //CLEAR FUNCTION
-    //Description: Clears a Network completely, removing all sensors.
-    void clearNetwork()
+  }
+  if (base_path != NULL)
+  {
+    printf("%d regression(s) against %s\n", regressions, base_path);
+  }
+  if (save_path != NULL && !saveBaseline(save_path, all))
+  {
+    return 1;
+  }
+  return (regressions > 0) ? 2 : 0;
+}
+#endif
+
+//////////////////////////////////////////////////////////////////////////
+/////////////////////////////MAIN_PROGRAM/////////////////////////////////
+//////////////////////////////////////////////////////////////////////////
+
+int main(int argc, char* argv[])
+{
+#ifdef SNMS_BENCHMARK
+  return runBenchmarks(argc, argv);
+#endif
+  /*-----DECLARATIONS-----*/
+  RunOptions opt; //Every setting of the run
+  TrialSetup & setup = opt.base; //Parameters shared by every trial
+  setup.num_missions = M_COUNT;
+  setup.radius = M_RAD;
+  setup.aoi_w = AOI_W;
+  setup.aoi_h = AOI_H;
+  setup.msv = MSV;
+  setup.num_trials = NUM_TEST;
+  setup.use_index = true;
+  setup.naive_offline = false;
+  setup.offline_threads = 1;
+  setup.use_graph = true;
+  setup.sweep_line = false;
+  setup.batch_window = 0;
+  setup.policy = NULL;
+  setup.ci_width = 0;
+  setup.max_trials = MAX_TEST;
+  setup.scenario_file = NULL;
+  setup.record_health = false;
+  setup.checkpoint_every = 60;
+  setup.resume = false;
+  setup.seed = time(NULL); //Seeds random number generation
+  opt.num_threads = thread::hardware_concurrency(); //Size of thread pool
+  opt.seeded = false;
+  opt.sweep_mode = false;
+  opt.json = false;
+  opt.stream_count = 0;
+  opt.pipeline = false;
+  opt.report_every = 1000000;
+  opt.shard_index = -1;
+  opt.shard_count = 0;
+  opt.workers = 1;
+  opt.merge = false;
+  for (int a = 1; a < argc; a++)
+  {
+    if (strcmp(argv[a], "--brute") == 0) //Disables the spatial index
     {
-      m_mission_count = 0;
-      m_mission_satis = 0;
-      for (int i = 0; i < m_num; i++)
-      {
-        m_sensor.pop_back();
-      }
-      m_num = 0;
+      setup.use_index = false;
     }
-   
-    //RESET FUNCTION
-    //Description: Resets a Network back to its original state. This
-    //retains all sensors used, and resets all of them as well.
-    void resetNetwork()
+    else if (strcmp(argv[a], "--naive-offline") == 0)
     {
-      m_mission_count = 0;
-      m_mission_satis = 0;
-      for (int i = 0; i < m_num; i++)
+      setup.naive_offline = true;
+    }
+    else if (strcmp(argv[a], "--no-graph") == 0) //Skips EligibilityGraph
+    {
+      setup.use_graph = false;
+    }
+    else if (strcmp(argv[a], "--sweep-line") == 0) //Event driven online
+    {
+      setup.sweep_line = true;
+    }
+    else if (strcmp(argv[a], "--no-simd") == 0) //Forces scalar kernels
+    {
+      use_simd = false;
+    }
+    else if (strcmp(argv[a], "--sweep") == 0)
+    {
+      opt.sweep_mode = true;
+    }
+    else if (strcmp(argv[a], "--pipeline") == 0) //Threaded stream stages
+    {
+      opt.pipeline = true;
+    }
+    else if (strcmp(argv[a], "--resume") == 0) //Picks up from --checkpoint
+    {
+      setup.resume = true;
+    }
+    else if (strcmp(argv[a], "--merge") == 0) //Takes any partial files
+    {
+      opt.merge = true;
+      while (a + 1 < argc && strncmp(argv[a + 1], "--", 2) != 0)
       {
-        m_sensor[i].resetSensor();
+        opt.merge_paths.push_back(argv[++a]);
       }
-      return;
     }
-    
-    //ADD SENSORS FUNCTION
-    //Description: Adds additional sensors to the network. Resets Network
-    //automatically.
-    void addSensors(const int sensor_count)
+    else if (strcmp(argv[a], "--config") == 0 && a + 1 < argc)
     {
-      resetNetwork();
-      m_num = m_num + sensor_count;
-      Sensor* temp;
-      for (int i = 0; i < sensor_count; i++)
+      opt.sweep_mode = true;
+      if (!readConfig(argv[++a], opt))
       {
-        temp = new Sensor;
-        m_sensor.push_back(*temp);
-        delete temp;
+        return 1;
       }
-      temp = NULL;
-      return;
     }
-    
-    //ACCESSOR FUNCTIONS    
-    int getNUM(){ return m_num; }
-    int getMISSIONCOUNT(){ return m_mission_count; } 
-    int getMISSIONSATIS(){ return m_mission_satis; }
-
-    //COUNT SCHEDULABLE FUNCTION
-    //Description: Used to count the number of sensors that are able to
-    //satisfy the "isSchedulable" function with regards to some mission.
-    int countSched(Mission & task)
+    else if (strncmp(argv[a], "--", 2) == 0 && a + 1 < argc &&
+             applyOption(argv[a] + 2, argv[a + 1], opt))
     {
-      int count_sch = 0; //Used to store amount of assignable sensors
-      for (int i = 0; i < m_num; i++)
+      a++;
+    }
+    else
+    {
+      cerr << "Unknown or invalid option: " << argv[a] << endl;
+      if (strcmp(argv[a], "--policy") == 0)
       {
-        if (m_sensor[i].isSchedulable(task)) //If a sensor can be assigned
+        cerr << "Policies:" << endl;
+        for (int p = 0; p < NUM_POLICIES; p++)
         {
-          count_sch++; //Amount of assignable sensors incremented
+          cerr << "  " << POLICY_REGISTRY[p].name << " - "
+               << POLICY_REGISTRY[p].about << endl;
         }
       }
-      return count_sch;
+      return 1;
     }
+  }
+  if (opt.num_threads < 1)
+  {
+    opt.num_threads = 1;
+  }
 
-    //LOW-ENERGY-SENSOR COUNTING FUNCTION
-    //Description: Returns the number of sensors that can no longer complete
-    //missions.
-    float calcLES(const int dura)const
+  /*-----SCENARIO FILES-----*/
+  SweepSpec & sw = opt.sweep;
+  ScenarioFile file; //Loaded scenario, if any
+  int max_sensors = INT_MAX; //Sensors available to the run
+  if (!opt.scenario_path.empty())
+  {
+    if (!file.load(opt.scenario_path.c_str()))
     {
-      int num_low_energy = 0;
-      for (int i = 0; i < m_num; i++)
+      return 1;
+    }
+    if (!sw.aoi.empty())
+    {
+      cerr << "The AoI is set by the scenario file" << endl;
+      return 1;
+    }
+    setup.scenario_file = &file;
+    setup.aoi_w = file.getAOIW();
+    setup.aoi_h = file.getAOIH();
+    setup.num_missions = file.getMISSIONCOUNT();
+    max_sensors = file.getSENSORCOUNT();
+    if (sw.missions.empty())
+    {
+      sw.missions.push_back(setup.num_missions);
+    }
+    if (*max_element(sw.missions.begin(), sw.missions.end()) >
+        setup.num_missions ||
+        (!sw.sensors.empty() &&
+         *max_element(sw.sensors.begin(), sw.sensors.end()) > max_sensors))
+    {
+      cerr << "The scenario file only holds " << max_sensors
+           << " sensors and " << setup.num_missions << " missions" << endl;
+      return 1;
+    }
+    if (opt.stream_count > 0 && sw.sensors.empty())
+    {
+      sw.sensors.push_back(max_sensors);
+    }
+  }
+  if (!opt.save_path.empty())
+  {
+    vector<SensorRecord> sensors; //Records of the saved layout
+    vector<MissionRecord> missions;
+    int num_sensors = sw.sensors.empty() ? max_sensors
+                                         : static_cast<int>(sw.sensors[0]);
+    int num_missions = sw.missions.empty() ? setup.num_missions
+                                           : static_cast<int>(sw.missions[0]);
+    if (setup.scenario_file != NULL) //Converts or trims a loaded layout
+    {
+      sensors.assign(file.getSENSORS(), file.getSENSORS() + num_sensors);
+      missions.assign(file.getMISSIONS(), file.getMISSIONS() + num_missions);
+    }
+    else //Saves the layout of trial 0
+    {
+      if (sw.sensors.size() != 1 || sw.duration.size() != 1)
       {
-        if (m_sensor[i].getENERGY() < dura)
-        { //If the sensor has than "dura" units of energy left
-          num_low_energy++;
-        }
+        cerr << "Saving a scenario needs single values of --duration and "
+             << "--sensors" << endl;
+        return 1;
       }
-      return num_low_energy;
-    }       
-    
-    //RANDOM ASSIGNMENT FUNCTION
-    //Description: This function first assesses whether or not a mission
-    //can be completed by the Network's sensors. If it can be completed,
-    //the function begins picking random sensors. If the chosen sensor
-    //can be assigned to the mission, it is. Otherwise, the function
-    //picks a new sensor. After the mission has had sufficient sensors
-    //assigned, it is marked as satisfied.
-    void randomAssign(Mission & task, const int  num_sensors)
-    {
-      task.attempted = true; //The mission is marked as attempted
-      if (countSched(task) >= num_sensors) //If there are enough sensors
-      { //available for scheduling, then mission can be assigned.
-        int index = 0;
-        int num_assigned = 0; //Stores sensors assigned
-        while (num_assigned < num_sensors) //While more sensors are needed
-        {
-            index = rand()%m_num; //Choose random sensor
-            if (m_sensor[index].isSchedulable(task))
-            {
-              m_sensor[index].enschedule(task);
-              num_assigned++;
-            }
-        }
-        m_mission_satis++; //Increments amount of missions satisfied
+      if (!sw.aoi.empty())
+      {
+        setup.aoi_w = static_cast<int>(sw.aoi[0]);
+        setup.aoi_h = setup.aoi_w;
+      }
+      int dura = static_cast<int>(sw.duration[0]);
+      Scenario layout;
+      layout.prepare(setup.seed, 0, setup.aoi_w, setup.aoi_h, setup.msv,
+                     num_sensors, num_missions);
+      for (int i = 0; i < num_sensors; i++)
+      {
+        const Sensor & sensor = layout.getSENSORS()[i];
+        SensorRecord r = {sensor.getSX(), sensor.getSY(), sensor.getENERGY()};
+        sensors.push_back(r);
+      }
+      for (int i = 0; i < num_missions; i++)
+      {
+        const Mission & task = layout.getMISSION(i);
+        MissionRecord r = {task.getSTART(), task.getSTART() + dura,
+                           task.getEX(), task.getEY()};
+        missions.push_back(r);
       }
-      m_mission_count++; //Another mission attempt is recorded
-      return;      
     }
+    return ScenarioFile::save(opt.save_path.c_str(), setup.aoi_w,
+                              setup.aoi_h, sensors.data(), num_sensors,
+                              missions.data(), num_missions) ? 0 : 1;
+  }
 
-    //MISSION ASSIGNMENT FUNCTION
-    //Description: This function is used to assign a mission to a Network.
-    //It first marks the mission as attempted, and then if there are enough
-    //sensors available to complete the mission, then the sensor with the
-    //most energy is assigned to the mission at every iteration until the
-    //amount of sensors needed is reached. The network then records it as a
-    //satisfied mission.
-    void missionAssign(Mission & task, const int  num_sensors)
+  /*-----STREAM MODE-----*/
+  if (opt.stream_count > 0 || !opt.stream_input.empty())
+  {
+    if (!setup.checkpoint_dir.empty())
     {
-      task.attempted = true; //The mission is marked as attempted
-      if (countSched(task) >= num_sensors)
-      {
-        int c_en = 0; //Stores energy of evaluated sensor
-        int c_max = 0; //Stores maximum found value amongst sensors
-        int MES_index = 0; //Stores index of max energy sensor
-        int num_assigned = 0; //Stores number of sensors assigned
-        while (num_assigned < num_sensors) //While more sensors are needed
-        {
-          c_max = 0;
-          MES_index = 0;
-          for (int k = 0; k < m_num; k++) //For all sensors
-          {
-            c_en = m_sensor[k].getENERGY();
-            if (m_sensor[k].isSchedulable(task) && c_en > c_max)
-            {
-              c_max = c_en;
-              MES_index = k;
-            }
-          }
-          m_sensor[MES_index].enschedule(task);
-          num_assigned++;
-        }
-        m_mission_satis++; //Increments amount of missions satisfied
-      }
-      m_mission_count++; //Another mission attempt is recorded
-      return;      
+      cerr << "Only interactive runs take checkpoints" << endl;
+      return 1;
+    }
+    if (sw.duration.size() != 1 || sw.sensors.size() != 1 ||
+        sw.req_sens.size() != 1 || sw.radius.size() > 1 || sw.aoi.size() > 1)
+    {
+      cerr << "A stream needs single values of --duration, --sensors and "
+           << "--req" << endl;
+      return 1;
     }
+    if (!setup.mix.empty())
+    {
+      cerr << "Streamed missions can't be drawn from a --mix" << endl;
+      return 1;
+    }
+    setup.duration = static_cast<int>(sw.duration[0]);
+    setup.num_sensors = static_cast<int>(sw.sensors[0]);
+    setup.req_sens = static_cast<int>(sw.req_sens[0]);
+    if (!sw.radius.empty())
+    {
+      setup.radius = static_cast<float>(sw.radius[0]);
+    }
+    if (!sw.aoi.empty())
+    {
+      setup.aoi_w = static_cast<int>(sw.aoi[0]);
+      setup.aoi_h = setup.aoi_w;
+    }
+    bool streamed = runStream(opt, cout);
+    SNMS_DUMP(cerr);
+    return streamed ? 0 : 1;
+  }
 
-    //TOTAL ENERGY CALCULATION FUNCTION
-    //Description: Used in the Offline Algorithm. Let us define the "TE", or
-    //Total Energy, of a mission as the sum of all remaining energy on all
-    //sensors that the mission would use if it were accepted. So, this function
-    //takes a mission and the amount of sensors needed as parameters, and then
-    //sums up all the energy amongst the sensors that would be assigned were
-    //that mission to be satisfied.
-    int calcTE(Mission & task, const int num_sensors)
+  /*-----SWEEP MODE-----*/
+  if (opt.sweep_mode || opt.merge || opt.shard_count > 0 ||
+      !sw.duration.empty() || !sw.sensors.empty() || !sw.req_sens.empty())
+  {
+    if (sw.duration.empty() || sw.sensors.empty() || sw.req_sens.empty())
     {
-      if (countSched(task) < num_sensors) //If there aren't enough sensors
-      { //available for scheduling, TE must be zero.
-        return 0;
+      cerr << "A sweep needs --duration, --sensors and --req" << endl;
+      return 1;
+    }
+    if (!setup.checkpoint_dir.empty())
+    {
+      cerr << "Only interactive runs take checkpoints" << endl;
+      return 1;
+    }
+    if (sw.missions.empty())
+    {
+      sw.missions.push_back(setup.num_missions);
+    }
+    if (sw.radius.empty())
+    {
+      sw.radius.push_back(setup.radius);
+    }
+    if (sw.aoi.empty())
+    {
+      sw.aoi.push_back(setup.aoi_w);
+    }
+    if (opt.merge || opt.shard_count > 0)
+    {
+      if (setup.ci_width > 0 || !opt.health_path.empty())
+      {
+        cerr << "Sharded sweeps can't use --ci-width or --health" << endl;
+        return 1;
       }
-      int TE = 0; //Total energy of across all sensors that would be used for a
-      //mission.
-      int num_chosen = 0; //Number of chosen sensors
-      vector<int> chosen_sensors; //Stores chosen sensor indexes
-      for (int k = 0; k < num_sensors; k++) //Finds required amount of sensors
-      {
-        int max_energy = 0; //Greatest energy value of avail. sensors
-        int temp = 0; //Stores current sensor's energy
-        int maxTE_index = 0; //Stores index of greatest energy sensors
-        for (int i = 0; i < m_num; i++) //Find maximum energy
-        {    
-          temp = 0;
-          bool repeated_index = false; //Stores if index i was already chosen
-          for (int h = 0; h < num_chosen; h++) //Tests if i was chosen
-          {
-            if (chosen_sensors[h] == i) //If i is an index already chosen
-            {
-              repeated_index = true;
-            }
-          }
-          if (!repeated_index) //If this index is not already chosen
-          {
-            temp = m_sensor[i].getENERGY();
-            if (m_sensor[i].isSchedulable(task) && temp > max_energy)
-            { //Sensor can be assigned and it has more energy than max_energy
-                max_energy = temp; //Update max_energy
-                maxTE_index = i; //Stores index of max_energy
-            }
-          }
-        }
-        max_energy = 0;
-        chosen_sensors.push_back(maxTE_index); //Marks sensor index as chosen
-        num_chosen++;
+      bool done;
+      if (opt.merge)
+      {
+        done = mergeShards(opt, cout);
       }
-      for (int p = 0; p < num_sensors; p++)
+      else if (opt.shard_index >= 0)
       {
-        TE += m_sensor[chosen_sensors[p]].getENERGY();
-        //Adds total energy of chosen sensor to total
+        done = runShard(opt, opt.shard_index, cout);
       }
-      return TE;
-    }      
-};  
-
-
-
-//////////////////////////////////////////////////////////////////////////
-/////////////////////////////MAIN_PROGRAM/////////////////////////////////
-//////////////////////////////////////////////////////////////////////////
-
-int main()
-{
-  /*-----DECLARATIONS-----*/
-  srand(time(NULL)); //Seeds random number generation
-  vector<Mission> List; //An vector that stores all of the missions.
-  Network WSN(0); //The WSN, which contains all the sensors.
-
-  int randomSA = 0;  //The three variables on the left are used to store the
-  int onlineSA = 0;  //Satisfaction Average, or the average amount of missions
-  int offlineSA = 0; //that were satisfied each iteration.
-  
-  int randomLEA = 0; //These three variables store the percentage of low-energy
-  int onlineLEA = 0; //sensors for the three algorithms on average after each
-  int offlineLEA = 0;//iteration.
-    
-  int index = 0; //Current mission being considered
+      else if (!opt.shard_dir.empty())
+      {
+        done = runShardWorkers(opt);
+      }
+      else
+      {
+        cerr << "--shards needs --shard-dir" << endl;
+        return 1;
+      }
+      SNMS_DUMP(cerr);
+      return done ? 0 : 1;
+    }
+    runSweep(opt, cout);
+    SNMS_DUMP(cerr);
+    return 0;
+  }
+  if (!sw.missions.empty()) //Single values given for an interactive run
+  {
+    setup.num_missions = static_cast<int>(sw.missions[0]);
+  }
+  if (!sw.radius.empty())
+  {
+    setup.radius = static_cast<float>(sw.radius[0]);
+  }
+  if (!sw.aoi.empty())
+  {
+    setup.aoi_w = static_cast<int>(sw.aoi[0]);
+    setup.aoi_h = setup.aoi_w;
+  }
   
   /*-----PARAMETER INPUT-----*/
   int input;
@@ -495,114 +6630,141 @@ int main()
   cin >> input;
   int REQ_SENS = input;
   cout << endl << endl;
-
-  /*-----PROGRAM BEGIN-----*/
-  for (int iterations = 0; iterations < NUM_TEST; iterations++)
+  setup.duration = M_DURATION;
+  setup.num_sensors = NUM_SENSORS;
+  setup.req_sens = REQ_SENS;
+  if (NUM_SENSORS > max_sensors)
   {
-    /*-----NETWORK GENERATION-----*/
-    WSN.addSensors(NUM_SENSORS);
-     
-    /*-----MISSION LIST GENERATION-----*/
-    int st = 0; //Stores start time of last mission
-    int dur = 0; //Stores duration
-    Mission* mstor; //Stores missions
-    for (int i = 0; i < M_COUNT; i++) //Mission Generation
-    {
-      st += (rand()%MSV);
-      dur = M_DURATION;
-      mstor = new Mission(st, dur);
-      List.push_back(*mstor);
-      delete mstor;
-    }
-    mstor = NULL;
-
-    /*-----RANDOM APPROACH-----*/
-    while (index < M_COUNT) //While there are more missions
-    {
-      WSN.randomAssign(List[index], REQ_SENS); //Attempts to complete mission
-      index++;
-    }
-    randomSA += WSN.getMISSIONSATIS(); //Adds to total satisfied missions
-    randomLEA += WSN.calcLES(M_DURATION);
+    cerr << "The scenario file only holds " << max_sensors << " sensors"
+         << endl;
+    return 1;
+  }
 
-    /*-----DATA PREP-----*/
-    index = 0;
-    WSN.resetNetwork();
-    for (int q = 0; q < M_COUNT; q++)
+  /*-----CHECKPOINTS-----*/
+  if (!setup.checkpoint_dir.empty())
+  {
+    struct stat info;
+    if (stat(setup.checkpoint_dir.c_str(), &info) != 0 ||
+        !S_ISDIR(info.st_mode))
     {
-      List[q].attempted = false;
+      cerr << "Checkpoint directory " << setup.checkpoint_dir
+           << " doesn't exist" << endl;
+      return 1;
     }
-
-    /*-----ONLINE APPROACH-----*/
-    while (index < M_COUNT) //While there are more missions
+    if (!opt.health_path.empty())
     {
-      WSN.missionAssign(List[index], REQ_SENS); //Attempts to complete mission
-      index++;
+      cerr << "Checkpointed runs can't use --health" << endl;
+      return 1;
     }
-    onlineSA += WSN.getMISSIONSATIS(); //Adds to total satisfied missions
-    onlineLEA += WSN.calcLES(M_DURATION);
-    
-    /*-----DATA PREP-----*/
-    index = 0;
-    WSN.resetNetwork();
-    for (int q = 0; q < M_COUNT; q++)
-    {
-      List[q].attempted = false;
+    int last = setup.ci_width > 0 ? setup.max_trials : setup.num_trials;
+    for (int t = 0; t < last && setup.resume && !opt.seeded; t++)
+    { //Takes the seed of the run being resumed
+      if (snapshotSeed(snapshotPath(setup, t), setup.seed))
+      {
+        opt.seeded = true;
+        cout << "Resuming the run with seed " << setup.seed << endl;
+      }
     }
-
-    /*-----OFFLINE APPROACH-----*/
-    int offcount = 0; //Used to count missions completed by offline algorithm
-    while (offcount < M_COUNT) //While there are more missions
+    ostringstream key; //Every setting a trial's results depend on
+    key << sweepKey(opt) << ";run=" << setup.duration << ","
+        << setup.num_sensors << "," << setup.req_sens << ","
+        << setup.num_missions << "," << setup.radius << "," << setup.aoi_w
+        << "," << setup.aoi_h;
+    setup.checkpoint_key = key.str();
+    for (int t = 0; t < last && setup.resume; t++) //Checks every snapshot
     {
-      index = 0; //Index is reset
-      int maxTE = 0; //Stores calculated max TE
-      for (int i = 0; i < M_COUNT; i++) //This loop finds the maximum TE
+      string header;
+      bool finished;
+      TrialResult unused;
+      RandGen unused_rng(setup.seed);
+      if (OfflineCheckpoint::load(snapshotPath(setup, t), header, NULL,
+                                  NULL) &&
+          !readTrialHeader(header, setup, t, finished, unused, unused_rng))
       {
-        int currentTE = WSN.calcTE(List[i], REQ_SENS); //Stores current TE
-        if (currentTE >= maxTE && List[i].attempted == false)
-        { //If the currentTE exceeds maxTE and that mission hasn't been chosen
-          maxTE = currentTE; //Max TE updated
-          index = i; //Index of mission with MAX TE updated
-        }
+        cerr << snapshotPath(setup, t) << " was written by a run with "
+             << "other settings" << endl;
+        return 1;
       }
-      WSN.missionAssign(List[index], REQ_SENS); //Attempts to complete mission
-      offcount++; //Additional mission attempt recorded
     }
-    offlineSA += WSN.getMISSIONSATIS(); //Adds to total satisfied missions
-    offlineLEA += WSN.calcLES(M_DURATION);
+  }
 
-    /*-----DATA CLEANUP-----*/
-    for (int i = 0; i < M_COUNT; i++) //Mission Generation
+  /*-----PROGRAM BEGIN-----*/
+  vector<Scenario> scenarios; //Layouts of every trial
+  vector<TrialResult> results; //Results of every trial
+  RunSummary sum; //Averages of every trial
+  setup.record_health = !opt.health_path.empty();
+  runTrials(setup, opt.num_threads, scenarios, results);
+  summarize(setup, results, sum);
+  if (setup.record_health)
+  {
+    ofstream health(opt.health_path.c_str());
+    writeHealth(setup, results, health);
+    if (!health)
     {
-      List.pop_back();
+      cerr << "Could not write health curves to " << opt.health_path
+           << endl;
+      return 1;
     }
-    WSN.clearNetwork(); //Deletes all sensors, resets data.  
-  }  
+  }
 
   /*-----RESULTS-----*/
-  float avg; //Used to output the calculated averages.
-  avg = static_cast<float>(randomSA)/(static_cast<float>((NUM_TEST*M_COUNT)));
-  cout << "The Random Algorithm's Satisfaction Rate was " << avg*100 << "%";
-  cout << endl;
-  avg = static_cast<float>(onlineSA)/(static_cast<float>((NUM_TEST*M_COUNT)));
-  cout << "The Online Algorithm's Satisfaction Rate was " << avg*100 << "%";
-  cout << endl;
-  avg = static_cast<float>(offlineSA)/(static_cast<float>((NUM_TEST*M_COUNT)));
-  cout << "The Offline Algorithm's Satisfaction Rate was " << avg*100 << "%";
-  cout << endl;
-  avg = static_cast<float>(randomLEA)/
-        (static_cast<float>((NUM_TEST*NUM_SENSORS)));
-  cout << "The Random Algorithm's Low Energy Percent was " << avg*100 << "%";
-  cout << endl;
-  avg = static_cast<float>(onlineLEA)/
-        (static_cast<float>((NUM_TEST*NUM_SENSORS)));
-  cout << "The Online Algorithm's Low Energy Percent was " << avg*100 << "%";
-  cout << endl;
-  avg = static_cast<float>(offlineLEA)/
-        (static_cast<float>((NUM_TEST*NUM_SENSORS)));
-  cout << "The Offline Algorithm's Low Energy Percent was " << avg*100 << "%";
-  cout << endl;
+  const float* hw = sum.half_width; //Half width of each 95% interval
+  writeResult(cout, "The Random Algorithm's Satisfaction Rate was ",
+              sum.random_sr, hw[M_RANDOM_SR]);
+  writeResult(cout, "The Online Algorithm's Satisfaction Rate was ",
+              sum.online_sr, hw[M_ONLINE_SR]);
+  writeResult(cout, "The Offline Algorithm's Satisfaction Rate was ",
+              sum.offline_sr, hw[M_OFFLINE_SR]);
+  writeResult(cout, "The Random Algorithm's Low Energy Percent was ",
+              sum.random_lep, hw[M_RANDOM_LEP]);
+  writeResult(cout, "The Online Algorithm's Low Energy Percent was ",
+              sum.online_lep, hw[M_ONLINE_LEP]);
+  writeResult(cout, "The Offline Algorithm's Low Energy Percent was ",
+              sum.offline_lep, hw[M_OFFLINE_LEP]);
+  if (setup.batch_window > 0)
+  {
+    writeResult(cout, "The Batch Algorithm's Satisfaction Rate was ",
+                sum.batch_sr, hw[M_BATCH_SR]);
+    writeResult(cout, "The Batch Algorithm's Low Energy Percent was ",
+                sum.batch_lep, hw[M_BATCH_LEP]);
+  }
+  if (setup.policy != NULL)
+  {
+    string name = setup.policy->name;
+    writeResult(cout, "The " + name + " Policy's Satisfaction Rate was ",
+                sum.policy_sr, hw[M_POLICY_SR]);
+    writeResult(cout, "The " + name + " Policy's Low Energy Percent was ",
+                sum.policy_lep, hw[M_POLICY_LEP]);
+  }
+  cout << "Averaged over " << results.size() << " trials" << endl;
+  if (!setup.checkpoint_dir.empty())
+  {
+    int written = 0; //Snapshots written by every trial
+    int resumed = 0; //Trials picked up from a snapshot
+    double cost = 0; //Time spent writing snapshots
+    double offline_secs = 0; //Time spent in offline passes
+    for (size_t t = 0; t < results.size(); t++)
+    {
+      written += results[t].checkpoints;
+      resumed += results[t].resumed;
+      cost += results[t].checkpoint_secs;
+      offline_secs += results[t].offline_secs;
+    }
+    cout << "Wrote " << written << " checkpoints in " << cost << " s, "
+         << (offline_secs > 0 ? 100*cost/offline_secs : 0)
+         << "% of the " << offline_secs << " s spent in offline passes";
+    if (resumed > 0)
+    {
+      cout << ", resuming " << resumed << " trials";
+    }
+    cout << endl;
+  }
+  if (setup.use_graph)
+  {
+    cout << "The largest Eligibility Graph had " << sum.graph_edges
+         << " edges and used " << sum.graph_bytes/1024.0 << " KiB" << endl;
+  }
+  SNMS_DUMP(cerr);
   
   return 0;
 }
-